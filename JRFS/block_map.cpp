@@ -0,0 +1,491 @@
+#include "details/extent.hpp"
+#include "details/index_block.hpp"
+#include "filesystem.hpp"
+#include <algorithm>
+
+namespace jrfs {
+
+// With block_mapping::extent, file & directory inodes map their blocks with extents:
+//   direct_block[0]       : The Directory It Lives In.
+//   direct_block[1 .. 18] : kInlineExtents (start, length) Pairs, Logically In Order.
+//   direct_block[19]      : Root Of The Overflow Extent Tree, For Extents Beyond The Inline Ones.
+static constexpr int kFirstExtentSlot = 1;
+static constexpr int kInlineExtents = 9;
+static constexpr int kTreeRootSlot = kFirstExtentSlot + 2 * kInlineExtents;
+
+static_assert(kTreeRootSlot + 1 == std::tuple_size<decltype(inode::direct_block)>::value, "Extents Must Fill The Inode!");
+
+static inline int& inline_start(inode& node, int k)
+{
+    return node.direct_block[kFirstExtentSlot + 2 * k];
+}
+
+static inline int& inline_length(inode& node, int k)
+{
+    return node.direct_block[kFirstExtentSlot + 2 * k + 1];
+}
+
+static inline int inline_start(const inode& node, int k)
+{
+    return node.direct_block[kFirstExtentSlot + 2 * k];
+}
+
+static inline int inline_length(const inode& node, int k)
+{
+    return node.direct_block[kFirstExtentSlot + 2 * k + 1];
+}
+
+// With block_mapping::indirect, file & directory inodes map their blocks with index blocks:
+//   direct_block[0]       : The Directory It Lives In.
+//   direct_block[1 .. 17] : Direct Blocks.
+//   direct_block[18]      : Single Indirect Block, Holding index_block::kIdsPerBlock Block Ids.
+//   direct_block[19]      : Double Indirect Block, Holding Ids Of Single Indirect Blocks.
+static constexpr int kFirstDirectSlot = 1;
+static constexpr int kDirectBlocks = 17;
+static constexpr int kSingleIndirectSlot = kFirstDirectSlot + kDirectBlocks;
+static constexpr int kDoubleIndirectSlot = kSingleIndirectSlot + 1;
+static constexpr int kIds = index_block::kIdsPerBlock;
+static constexpr int kMaxIndirectBlocks = kDirectBlocks + kIds + kIds * kIds;
+
+static_assert(kDoubleIndirectSlot + 1 == std::tuple_size<decltype(inode::direct_block)>::value, "Indirect Blocks Must Fill The Inode!");
+
+static int indirect_block_id(const filesystem& fs, const inode& node, int nth)
+{
+    if (nth < kDirectBlocks)
+        return node.direct_block[kFirstDirectSlot + nth];
+
+    nth -= kDirectBlocks;
+    if (nth < kIds) {
+        const int single = node.direct_block[kSingleIndirectSlot];
+        return single == kNULL ? kNULL : index_block::get(fs.block_list[single], nth);
+    }
+
+    nth -= kIds;
+    if (nth < kIds * kIds) {
+        const int dbl = node.direct_block[kDoubleIndirectSlot];
+        if (dbl == kNULL)
+            return kNULL;
+        const int single = index_block::get(fs.block_list[dbl], nth / kIds);
+        return single == kNULL ? kNULL : index_block::get(fs.block_list[single], nth % kIds);
+    }
+    return kNULL;
+}
+
+static int indirect_block_count(const filesystem& fs, const inode& node)
+{ // Mapped Blocks Always Form A Prefix, So Binary Search Its End.
+    int lo = 0, hi = kMaxIndirectBlocks;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (indirect_block_id(fs, node, mid) != kNULL)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void indirect_append(filesystem& fs, int inode_id, int nth, int block, std::vector<int>& map_blocks)
+{
+    auto& node = fs.inode_list[inode_id];
+    fs.mark_dirty_inode(inode_id);
+
+    if (nth < kDirectBlocks) {
+        node.direct_block[kFirstDirectSlot + nth] = block;
+        return;
+    }
+
+    nth -= kDirectBlocks;
+    if (nth < kIds) {
+        if (node.direct_block[kSingleIndirectSlot] == kNULL)
+            node.direct_block[kSingleIndirectSlot] = fs.allocate_map_block(map_blocks);
+        const int single = node.direct_block[kSingleIndirectSlot];
+        index_block::set(fs.block_list[single], nth, block);
+        fs.mark_dirty_block(single);
+        return;
+    }
+
+    nth -= kIds;
+    if (nth >= kIds * kIds)
+        throw std::logic_error("File Too Large! Indirect Mapping Holds At Most " + std::to_string(kMaxIndirectBlocks) + " Blocks.");
+
+    if (node.direct_block[kDoubleIndirectSlot] == kNULL)
+        node.direct_block[kDoubleIndirectSlot] = fs.allocate_map_block(map_blocks);
+    const int dbl = node.direct_block[kDoubleIndirectSlot];
+
+    int single = index_block::get(fs.block_list[dbl], nth / kIds);
+    if (single == kNULL) {
+        single = fs.allocate_map_block(map_blocks);
+        index_block::set(fs.block_list[dbl], nth / kIds, single);
+        fs.mark_dirty_block(dbl);
+    }
+    index_block::set(fs.block_list[single], nth % kIds, block);
+    fs.mark_dirty_block(single);
+}
+
+static void indirect_visit(const filesystem& fs, const inode& node, const std::function<void(int)>& fn)
+{ // Only Index Blocks Are Read, Never The Data Blocks.
+    auto visit_index = [&](int index_id) {
+        fn(index_id);
+        for (int i = 0; i < kIds; ++i) {
+            const int id = index_block::get(fs.block_list[index_id], i);
+            if (id == kNULL)
+                break;
+            fn(id);
+        }
+    };
+
+    for (int i = 0; i < kDirectBlocks && node.direct_block[kFirstDirectSlot + i] != kNULL; ++i)
+        fn(node.direct_block[kFirstDirectSlot + i]);
+
+    if (node.direct_block[kSingleIndirectSlot] != kNULL)
+        visit_index(node.direct_block[kSingleIndirectSlot]);
+
+    const int dbl = node.direct_block[kDoubleIndirectSlot];
+    if (dbl != kNULL) {
+        fn(dbl);
+        for (int i = 0; i < kIds; ++i) {
+            const int single = index_block::get(fs.block_list[dbl], i);
+            if (single == kNULL)
+                break;
+            visit_index(single);
+        }
+    }
+}
+
+int filesystem::block_id(const inode& node, int nth) const
+{
+    return block_run(node, nth).start;
+}
+
+extent filesystem::block_run(const inode& node, int nth) const
+{
+    const extent unmapped { nth, kNULL, 0 };
+    if (nth < 0)
+        return unmapped;
+
+    if (meta_data.mapping == block_mapping::indirect) {
+        const int id = indirect_block_id(*this, node, nth);
+        return id == kNULL ? unmapped : extent { nth, id, 1 };
+    }
+
+    int logical = 0;
+    for (int k = 0; k < kInlineExtents; ++k) {
+        if (inline_start(node, k) == kNULL)
+            return unmapped;
+        if (nth < logical + inline_length(node, k))
+            return { nth, inline_start(node, k) + (nth - logical), logical + inline_length(node, k) - nth };
+        logical += inline_length(node, k);
+    }
+
+    // Binary Search Down The Extent Tree.
+    int node_id = node.direct_block[kTreeRootSlot];
+    while (node_id != kNULL) {
+        const auto tree_node = extent_node::load(block_list[node_id]);
+        const int i = tree_node.find(nth);
+        if (i < 0)
+            return unmapped;
+        if (tree_node.depth == 0) {
+            const auto& e = tree_node.extents[i];
+            if (nth >= e.logical + e.length)
+                return unmapped;
+            return { nth, e.start + (nth - e.logical), e.logical + e.length - nth };
+        }
+        node_id = tree_node.children[i].child;
+    }
+    return unmapped;
+}
+
+int filesystem::block_count(const inode& node) const
+{
+    if (meta_data.mapping == block_mapping::indirect)
+        return indirect_block_count(*this, node);
+
+    int logical = 0;
+    for (int k = 0; k < kInlineExtents; ++k) {
+        if (inline_start(node, k) == kNULL)
+            return logical;
+        logical += inline_length(node, k);
+    }
+
+    // The Last Extent Of The Rightmost Leaf Ends The File.
+    int node_id = node.direct_block[kTreeRootSlot];
+    while (node_id != kNULL) {
+        const auto tree_node = extent_node::load(block_list[node_id]);
+        if (tree_node.depth == 0) {
+            const auto& e = tree_node.extents[tree_node.count - 1];
+            return e.logical + e.length;
+        }
+        node_id = tree_node.children[tree_node.count - 1].child;
+    }
+    return logical;
+}
+
+int filesystem::allocate_map_block()
+{
+    long id = block_bitmap.allocate();
+
+    if (id < 0)
+        throw std::logic_error("Blocks Not Enough! 1 required by the block map.");
+    block_list.zeroed(id); // Empty Entries Must Read As kNULL.
+    mark_dirty_block(id);
+    mark_fresh_block(id);
+    return id;
+}
+
+int filesystem::allocate_map_block(std::vector<int>& map_blocks)
+{
+    if (map_blocks.empty())
+        return allocate_map_block();
+    const int id = map_blocks.back();
+    map_blocks.pop_back();
+    block_list.zeroed(id); // Empty Entries Must Read As kNULL.
+    mark_dirty_block(id);
+    mark_fresh_block(id);
+    return id;
+}
+
+static int ceil_div(int a, int b)
+{
+    return (a + b - 1) / b;
+}
+
+int filesystem::map_blocks_needed(const inode& node, int mapped, int count, int runs) const
+{
+    if (meta_data.mapping == block_mapping::indirect) { // Exact: Index Blocks Covering [mapped, count) That Do Not Exist Yet.
+        int needed = 0;
+        if (mapped < kDirectBlocks + kIds && count > kDirectBlocks && node.direct_block[kSingleIndirectSlot] == kNULL)
+            ++needed;
+        const int base = kDirectBlocks + kIds;
+        if (count > base) {
+            if (node.direct_block[kDoubleIndirectSlot] == kNULL)
+                ++needed;
+            const int first_new = mapped <= base ? 0 : ceil_div(mapped - base, kIds);
+            const int last = (count - 1 - base) / kIds;
+            needed += std::max(0, last - first_new + 1);
+        }
+        return needed;
+    }
+
+    // Extent: An Upper Bound. Each Run Adds At Most One Extent, And A New Node Is Only Started Once
+    // The Rightmost One Is Full, So Every Level Gains At Most ceil(new nodes below / fan-out).
+    if (runs == 0)
+        return 0;
+    int nodes = ceil_div(runs, extent_node::kMaxExtents);
+    int needed = nodes;
+    const int root_id = node.direct_block[kTreeRootSlot];
+    int total = nodes; // Nodes On The Level Just Counted, When It Is Above The Current Root.
+    if (root_id != kNULL) {
+        const int depth = extent_node::load(block_list[root_id]).depth;
+        for (int level = 1; level <= depth; ++level) {
+            nodes = ceil_div(nodes, extent_node::kMaxChildren);
+            needed += nodes;
+        }
+        total = nodes + 1; // The Old Root Joins Them.
+    }
+    while (total > 1) { // New Roots Stacked On Top.
+        total = ceil_div(total, extent_node::kMaxChildren);
+        needed += total;
+    }
+    return needed;
+}
+
+std::pair<int, int> filesystem::append_to_extent_tree(int node_id, const extent& e, std::vector<int>& map_blocks)
+{
+    auto tree_node = extent_node::load(block_list[node_id]);
+
+    if (tree_node.depth == 0) {
+        if (tree_node.count > 0) { // Just Grow The Last Extent If Contiguous.
+            auto& last = tree_node.extents[tree_node.count - 1];
+            if (last.start + last.length == e.start && last.logical + last.length == e.logical) {
+                last.length += e.length;
+                tree_node.store(block_list[node_id]);
+                mark_dirty_block(node_id);
+                return { kNULL, 0 };
+            }
+        }
+
+        if (tree_node.count < extent_node::kMaxExtents) {
+            tree_node.extents[tree_node.count++] = e;
+            tree_node.store(block_list[node_id]);
+            mark_dirty_block(node_id);
+            return { kNULL, 0 };
+        }
+
+        // Full. Files Only Grow At The Tail, So Start A New Rightmost Leaf Instead Of Splitting.
+        extent_node leaf{};
+        leaf.extents[leaf.count++] = e;
+        const int leaf_id = allocate_map_block(map_blocks);
+        leaf.store(block_list[leaf_id]);
+        return { leaf_id, e.logical };
+    }
+
+    const auto [child_id, child_logical] = append_to_extent_tree(tree_node.children[tree_node.count - 1].child, e, map_blocks);
+    if (child_id == kNULL)
+        return { kNULL, 0 };
+
+    if (tree_node.count < extent_node::kMaxChildren) {
+        tree_node.children[tree_node.count++] = { child_logical, child_id };
+        tree_node.store(block_list[node_id]);
+        mark_dirty_block(node_id);
+        return { kNULL, 0 };
+    }
+
+    extent_node sibling{};
+    sibling.depth = tree_node.depth;
+    sibling.children[sibling.count++] = { child_logical, child_id };
+    const int sibling_id = allocate_map_block(map_blocks);
+    sibling.store(block_list[sibling_id]);
+    return { sibling_id, child_logical };
+}
+
+void filesystem::append_extent(int inode_id, const extent& e, std::vector<int>& map_blocks)
+{
+    auto& node = inode_list[inode_id];
+    mark_dirty_inode(inode_id);
+
+    int& root_id = node.direct_block[kTreeRootSlot];
+    if (root_id == kNULL) {
+        int k = 0;
+        while (k < kInlineExtents && inline_start(node, k) != kNULL)
+            ++k;
+
+        if (k > 0 && inline_start(node, k - 1) + inline_length(node, k - 1) == e.start) {
+            inline_length(node, k - 1) += e.length;
+            return;
+        }
+
+        if (k < kInlineExtents) {
+            inline_start(node, k) = e.start;
+            inline_length(node, k) = e.length;
+            return;
+        }
+
+        // Inline Extents Are Used Up. Overflow To A Tree.
+        extent_node leaf{};
+        leaf.extents[leaf.count++] = e;
+        root_id = allocate_map_block(map_blocks);
+        leaf.store(block_list[root_id]);
+        return;
+    }
+
+    const auto [sibling_id, sibling_logical] = append_to_extent_tree(root_id, e, map_blocks);
+    if (sibling_id == kNULL)
+        return;
+
+    // The Root Was Full: Grow The Tree By One Level.
+    const auto old_root = extent_node::load(block_list[root_id]);
+    extent_node new_root{};
+    new_root.depth = old_root.depth + 1;
+    new_root.children[new_root.count++] = { old_root.depth == 0 ? old_root.extents[0].logical : old_root.children[0].logical, root_id };
+    new_root.children[new_root.count++] = { sibling_logical, sibling_id };
+    root_id = allocate_map_block(map_blocks);
+    new_root.store(block_list[root_id]);
+}
+
+void filesystem::append_blocks(int inode_id, const std::vector<int>& block_ids, std::vector<int>& map_blocks)
+{
+    int logical = block_count(inode_list[inode_id]);
+    if (meta_data.mapping == block_mapping::indirect) {
+        for (int id : block_ids)
+            indirect_append(*this, inode_id, logical++, id, map_blocks);
+        return;
+    }
+
+    for (size_t i = 0; i < block_ids.size();) { // Map Each Run Of Contiguous Blocks As One Extent.
+        size_t j = i + 1;
+        while (j < block_ids.size() && block_ids[j] == block_ids[j - 1] + 1)
+            ++j;
+
+        const int length = j - i;
+        append_extent(inode_id, { logical, block_ids[i], length }, map_blocks);
+        logical += length;
+        i = j;
+    }
+}
+
+static void visit_extent_tree(const block_cache& block_list, int node_id, const std::function<void(int)>& fn)
+{
+    fn(node_id);
+    const auto tree_node = extent_node::load(block_list[node_id]);
+    for (int i = 0; i < tree_node.count; ++i) {
+        if (tree_node.depth == 0) {
+            const auto& e = tree_node.extents[i];
+            for (int b = e.start; b < e.start + e.length; ++b)
+                fn(b);
+        } else {
+            visit_extent_tree(block_list, tree_node.children[i].child, fn);
+        }
+    }
+}
+
+void filesystem::visit_blocks(const inode& node, const std::function<void(int)>& fn) const
+{
+    if (meta_data.mapping == block_mapping::indirect)
+        return indirect_visit(*this, node, fn);
+
+    for (int k = 0; k < kInlineExtents && inline_start(node, k) != kNULL; ++k)
+        for (int b = inline_start(node, k); b < inline_start(node, k) + inline_length(node, k); ++b)
+            fn(b);
+
+    if (node.direct_block[kTreeRootSlot] != kNULL)
+        visit_extent_tree(block_list, node.direct_block[kTreeRootSlot], fn);
+}
+
+void filesystem::reserve_blocks(int inode_id, int count)
+{
+    const int mapped = block_count(inode_list[inode_id]);
+    if (count <= mapped)
+        return;
+    if (meta_data.mapping == block_mapping::indirect && count > kMaxIndirectBlocks)
+        throw std::logic_error("File Too Large! Indirect Mapping Holds At Most " + std::to_string(kMaxIndirectBlocks) + " Blocks.");
+
+    metrics::scoped_timer timer(op_metrics, metric_op::allocate);
+    // Continue Right After The Last Block, So Sequential Appends Stay Physically Contiguous.
+    long goal = mapped > 0 ? block_id(inode_list[inode_id], mapped - 1) + 1 : -1;
+    const size_t needed = count - mapped;
+    std::vector<int> block_ids;
+    block_ids.reserve(needed);
+    size_t probes = 0;
+    while (block_ids.size() < needed) {
+        const auto [start, length] = block_bitmap.allocate_run(goal, needed - block_ids.size(), kMetricsEnabled ? &probes : nullptr);
+        if (start < 0) {
+            for (int allocated : block_ids)
+                block_bitmap.reset(allocated);
+            throw std::logic_error("Blocks Not Enough! " + std::to_string(needed - block_ids.size()) + " required.");
+        }
+        for (size_t i = 0; i < length; ++i)
+            block_ids.push_back(start + i);
+        goal = start + length;
+    }
+
+    // Claim Every Block The Mapping Can Need Up Front, So A Full Image Fails Before Anything Is Mapped.
+    int runs = 1;
+    for (size_t i = 1; i < block_ids.size(); ++i)
+        runs += block_ids[i] != block_ids[i - 1] + 1;
+    std::vector<int> map_blocks;
+    const int map_needed = map_blocks_needed(inode_list[inode_id], mapped, count, runs);
+    map_blocks.reserve(map_needed);
+    while (static_cast<int>(map_blocks.size()) < map_needed) {
+        const long id = block_bitmap.allocate();
+        if (id < 0) {
+            for (int allocated : block_ids)
+                block_bitmap.reset(allocated);
+            for (int allocated : map_blocks)
+                block_bitmap.reset(allocated);
+            throw std::logic_error("Blocks Not Enough! " + std::to_string(map_needed - map_blocks.size()) + " required by the block map.");
+        }
+        map_blocks.push_back(id);
+    }
+    std::reverse(map_blocks.begin(), map_blocks.end()); // Hand Them Out Lowest First.
+
+    append_blocks(inode_id, block_ids, map_blocks);
+    for (int id : block_ids) { // Whatever They Held Is Garbage, So Never Read Them In.
+        block_list.zeroed(id);
+        mark_fresh_block(id);
+    }
+    for (int unused : map_blocks)
+        block_bitmap.reset(unused);
+    op_metrics.add_allocation(block_ids.size(), probes);
+}
+
+}
\ No newline at end of file
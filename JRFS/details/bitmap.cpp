@@ -0,0 +1,285 @@
+#include "bitmap.hpp"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace jrfs {
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+    "Bitmap Words Are Read From And Written To The Image In Place.");
+
+bitmap::bitmap(size_t n)
+    : m_words((n + kWordBits - 1) / kWordBits)
+    , m_summary((m_words.size() + kWordBits - 1) / kWordBits)
+    , m_dirty_flags(new std::atomic<bool>[m_words.size()])
+    , m_dirty_lock(new std::mutex)
+    , m_cursors(new std::atomic<size_t>[kGroupCount])
+    , m_size(n)
+{
+    for (auto& word : m_words)
+        word.store(0, std::memory_order_relaxed);
+    for (auto& word : m_summary)
+        word.store(0, std::memory_order_relaxed);
+    for (size_t g = 0; g < kGroupCount; ++g)
+        m_cursors[g].store(0, std::memory_order_relaxed);
+    rebuild_summary();
+
+    m_dirty.resize(m_words.size());
+    for (size_t w = 0; w < m_words.size(); ++w) {
+        m_dirty_flags[w].store(true, std::memory_order_relaxed);
+        m_dirty.mark(w);
+    }
+}
+
+size_t bitmap::word_count() const
+{
+    return m_words.size();
+}
+
+uint64_t* bitmap::words()
+{
+    return reinterpret_cast<uint64_t*>(m_words.data());
+}
+
+const uint64_t* bitmap::words() const
+{
+    return reinterpret_cast<const uint64_t*>(m_words.data());
+}
+
+dirty_set& bitmap::dirty_words()
+{
+    return m_dirty;
+}
+
+void bitmap::clear_dirty()
+{
+    for (size_t w = 0; w < m_words.size(); ++w)
+        m_dirty_flags[w].store(false, std::memory_order_relaxed);
+    m_dirty.clear();
+}
+
+void bitmap::mark_dirty(size_t word_index)
+{
+    if (m_dirty_flags[word_index].exchange(true, std::memory_order_relaxed))
+        return;
+    std::lock_guard lock(*m_dirty_lock);
+    m_dirty.mark(word_index);
+}
+
+void bitmap::rebuild_summary()
+{
+    if (m_size % kWordBits != 0) // Bits Beyond The End Are Never Free.
+        m_words.back() |= ~uint64_t{ 0 } << (m_size % kWordBits);
+
+    for (size_t w = 0; w < m_words.size(); ++w)
+        update_summary(w);
+}
+
+size_t bitmap::size() const
+{
+    return m_size;
+}
+
+bool bitmap::test(size_t i) const
+{
+    return (m_words[i / kWordBits].load(std::memory_order_acquire) >> (i % kWordBits)) & 1;
+}
+
+bool bitmap::operator[](size_t i) const
+{
+    return test(i);
+}
+
+void bitmap::set(size_t i)
+{
+    m_words[i / kWordBits].fetch_or(uint64_t{ 1 } << (i % kWordBits), std::memory_order_acq_rel);
+    update_summary(i / kWordBits);
+    mark_dirty(i / kWordBits);
+}
+
+void bitmap::reset(size_t i)
+{
+    m_words[i / kWordBits].fetch_and(~(uint64_t{ 1 } << (i % kWordBits)), std::memory_order_acq_rel);
+    update_summary(i / kWordBits);
+    mark_dirty(i / kWordBits);
+}
+
+void bitmap::update_summary(size_t word_index)
+{
+    // Publish What We Saw, Then Re-check: If The Word Changed Meanwhile, Its Writer
+    // May Have Published Before Us, So Publish Again Until The Two Agree.
+    const uint64_t bit = uint64_t{ 1 } << (word_index % kWordBits);
+    auto& summary = m_summary[word_index / kWordBits];
+    bool has_free = ~m_words[word_index].load(std::memory_order_acquire) != 0;
+    for (;;) {
+        if (has_free)
+            summary.fetch_or(bit, std::memory_order_acq_rel);
+        else
+            summary.fetch_and(~bit, std::memory_order_acq_rel);
+        const bool now_free = ~m_words[word_index].load(std::memory_order_acquire) != 0;
+        if (now_free == has_free)
+            return;
+        has_free = now_free;
+    }
+}
+
+std::atomic<size_t>& bitmap::cursor() const
+{
+    static thread_local const size_t group = std::hash<std::thread::id> {}(std::this_thread::get_id()) % kGroupCount;
+    return m_cursors[group];
+}
+
+void bitmap::on_collision(std::atomic<size_t>& cur, size_t i) const
+{
+    const size_t group = &cur - m_cursors.get();
+    const size_t group_size = (m_size + kGroupCount - 1) / kGroupCount;
+    const size_t begin = group * group_size;
+    if (i < begin || i >= begin + group_size)
+        cur.store(begin, std::memory_order_relaxed);
+    else
+        cur.store(i + 1, std::memory_order_relaxed);
+}
+
+long bitmap::find_first_zero(size_t from) const
+{
+    if (from >= m_size)
+        return -1;
+
+    // Check The Rest Of The Word Containing `from`.
+    size_t w = from / kWordBits;
+    const uint64_t free_bits = ~m_words[w].load(std::memory_order_acquire) & (~uint64_t{ 0 } << (from % kWordBits));
+    if (free_bits != 0)
+        return w * kWordBits + __builtin_ctzll(free_bits);
+
+    // Then Skip Full Words Via The Summary.
+    size_t next = w + 1;
+    for (size_t s = next / kWordBits; s < m_summary.size(); ++s) {
+        uint64_t non_full = m_summary[s].load(std::memory_order_acquire);
+        if (s == next / kWordBits)
+            non_full &= ~uint64_t{ 0 } << (next % kWordBits);
+        while (non_full != 0) {
+            w = s * kWordBits + __builtin_ctzll(non_full);
+            const uint64_t word = m_words[w].load(std::memory_order_acquire);
+            if (~word != 0) // The Summary May Lag Behind A Concurrent Allocation.
+                return w * kWordBits + __builtin_ctzll(~word);
+            non_full &= non_full - 1;
+        }
+    }
+    return -1;
+}
+
+long bitmap::allocate()
+{
+    auto& cur = cursor();
+    for (;;) {
+        long i = find_first_zero(cur.load(std::memory_order_relaxed));
+        if (i < 0)
+            i = find_first_zero(0);
+        if (i < 0)
+            return -1;
+
+        const uint64_t bit = uint64_t{ 1 } << (i % kWordBits);
+        if ((m_words[i / kWordBits].fetch_or(bit, std::memory_order_acq_rel) & bit) == 0) {
+            update_summary(i / kWordBits);
+            mark_dirty(i / kWordBits);
+            cur.store(i + 1, std::memory_order_relaxed);
+            return i;
+        }
+        on_collision(cur, i);
+    }
+}
+
+std::pair<long, size_t> bitmap::allocate_run(long goal, size_t n, size_t* probes)
+{
+    if (n == 0)
+        return { -1, 0 };
+
+    auto& cur = cursor();
+    for (;;) {
+        long start = -1;
+        size_t length = 0;
+        const size_t hint = std::min(cur.load(std::memory_order_relaxed), m_size);
+        if (goal >= 0 && static_cast<size_t>(goal) < m_size && !test(goal)) {
+            start = goal;
+            length = find_first_one(goal) - goal;
+            if (probes != nullptr)
+                ++*probes;
+        } else { // First Fit From The Next-Fit Hint (Wrapping Around), Keeping The Longest Run Seen.
+            for (int pass = 0; pass < 2 && length < n; ++pass) {
+                const size_t limit = pass == 0 ? m_size : hint;
+                size_t from = pass == 0 ? hint : 0;
+                while (from < limit && length < n) {
+                    const long s = find_first_zero(from);
+                    if (s < 0 || static_cast<size_t>(s) >= limit)
+                        break;
+                    const size_t e = find_first_one(s);
+                    if (probes != nullptr)
+                        ++*probes;
+                    if (e - s > length)
+                        start = s, length = e - s;
+                    from = e;
+                }
+            }
+        }
+
+        if (start < 0)
+            return { -1, 0 };
+
+        // Another Thread May Take Part Of The Run Between The Scan And The Claim.
+        length = claim_run(start, std::min(length, n));
+        if (length > 0) {
+            cur.store(start + length, std::memory_order_relaxed);
+            return { start, length };
+        }
+        on_collision(cur, start);
+        goal = -1;
+    }
+}
+
+size_t bitmap::find_first_one(size_t from) const
+{
+    if (from >= m_size)
+        return m_size;
+
+    size_t w = from / kWordBits;
+    uint64_t used_bits = m_words[w].load(std::memory_order_acquire) & (~uint64_t{ 0 } << (from % kWordBits));
+    while (used_bits == 0) {
+        if (++w == m_words.size())
+            return m_size;
+        used_bits = m_words[w].load(std::memory_order_acquire);
+    }
+    return std::min(m_size, w * kWordBits + __builtin_ctzll(used_bits));
+}
+
+size_t bitmap::claim_run(size_t start, size_t n)
+{
+    size_t claimed = 0;
+    while (claimed < n) {
+        const size_t pos = start + claimed;
+        const size_t w = pos / kWordBits;
+        const size_t offset = pos % kWordBits;
+        const size_t bits = std::min(n - claimed, kWordBits - offset);
+        const uint64_t mask = bits == kWordBits ? ~uint64_t{ 0 } : ((uint64_t{ 1 } << bits) - 1) << offset;
+
+        uint64_t old = m_words[w].load(std::memory_order_acquire);
+        uint64_t taken;
+        do {
+            // Only The Free Prefix Of The Mask Keeps The Run Contiguous.
+            taken = mask;
+            if (const uint64_t used = old & mask; used != 0)
+                taken &= (uint64_t{ 1 } << __builtin_ctzll(used)) - 1;
+            if (taken == 0)
+                return claimed;
+        } while (!m_words[w].compare_exchange_weak(old, old | taken, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        update_summary(w);
+        mark_dirty(w);
+        const size_t got = __builtin_popcountll(taken);
+        claimed += got;
+        if (got < bits)
+            break;
+    }
+    return claimed;
+}
+
+}
\ No newline at end of file
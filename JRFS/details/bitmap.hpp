@@ -0,0 +1,106 @@
+#pragma once
+
+#include "dirty_set.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace jrfs {
+
+/// \brief 按64位字压缩的空闲位图，可被多个线程无锁地并发分配与释放。
+/// 每个字都是原子变量，占用与释放通过对整字的compare-and-swap完成；
+/// 另有一层摘要位图记录哪些字还有空闲位，查找空闲位时先在摘要中用ctz跳过已满的字。
+/// 分配时从本线程所在分配组上一次分配的位置继续查找（next-fit）；一旦与其他线程争抢同一个字失败，
+/// 本线程就转到位图中属于自己分配组的那一段，此后各线程在互不重叠的区域中分配，不再相互争用。
+class bitmap {
+public:
+    bitmap() = default;
+
+    /// \param n 位的总数，初始全部空闲（且全部的字都被视为脏的，因为尚未写入镜像）
+    explicit bitmap(size_t n);
+
+    /// \return 位的总数
+    size_t size() const;
+
+    /// \param i 位下标
+    /// \return 该位是否被占用
+    bool test(size_t i) const;
+
+    /// \param i 位下标
+    /// \return 该位是否被占用
+    bool operator[](size_t i) const;
+
+    /// \param i 位下标
+    /// \brief 占用一位
+    void set(size_t i);
+
+    /// \param i 位下标
+    /// \brief 释放一位
+    void reset(size_t i);
+
+    /// \param from 起始下标
+    /// \return [from, size)中第一个空闲位的下标，没有则返回-1
+    long find_first_zero(size_t from = 0) const;
+
+    /// \brief 从本线程上一次分配处开始（到尾部后回绕）查找并占用一个空闲位
+    /// \return 被占用位的下标，已满则返回-1
+    long allocate();
+
+    /// \brief 占用一段连续的空闲位：优先从goal处开始；否则从本线程上一次分配处开始找第一段不短于n的空闲段；
+    /// 都没有时退而占用最长的一段空闲段。与其他线程争抢时，得到的段可能比找到的空闲段短
+    /// \param goal 期望的起始下标，小于0表示没有期望
+    /// \param n 期望的长度
+    /// \param probes 非空时累加本次检查过的空闲段个数（含争抢失败后的重试），用于统计扫描长度
+    /// \return 被占用段的起始下标与长度（1 <= 长度 <= n），已满则返回{-1, 0}
+    std::pair<long, size_t> allocate_run(long goal, size_t n, size_t* probes = nullptr);
+
+    /// \return 位图所占64位字的个数
+    size_t word_count() const;
+
+    /// \return 位图的原始字，可用于直接从镜像中读入或写回镜像；使用期间不得有并发的分配或释放
+    uint64_t* words();
+    const uint64_t* words() const;
+
+    /// \brief 直接修改了words()之后调用，重建摘要层
+    void rebuild_summary();
+
+    /// \return 上次写回以来被修改过的字；使用期间不得有并发的分配或释放
+    dirty_set& dirty_words();
+
+    /// \brief 写回之后调用，清空被修改过的字的记录
+    void clear_dirty();
+
+private:
+    static constexpr size_t kWordBits = 64;
+    static constexpr size_t kGroupCount = 16; ///< 分配组的个数，线程按id散列到其中之一
+
+    void update_summary(size_t word_index);
+    void mark_dirty(size_t word_index);
+
+    /// \return 本线程所在分配组的next-fit起点
+    std::atomic<size_t>& cursor() const;
+
+    /// \brief 在i处与其他线程争抢失败后调用：不在本组的区域内时，把起点移到本组区域的开头
+    void on_collision(std::atomic<size_t>& cur, size_t i) const;
+
+    /// \return [from, size)中第一个被占用位的下标，没有则返回size
+    size_t find_first_one(size_t from) const;
+
+    /// \brief 尽量占用[start, start + n)：逐字CAS，遇到已被其他线程占用的位即停止
+    /// \return 实际占用的长度，为0说明start处已被占用
+    size_t claim_run(size_t start, size_t n);
+
+    std::vector<std::atomic<uint64_t>> m_words; ///< 位图本体，1为占用；尾部多余的位恒为1
+    std::vector<std::atomic<uint64_t>> m_summary; ///< 第w位为1表示m_words[w]还有空闲位
+    std::unique_ptr<std::atomic<bool>[]> m_dirty_flags; ///< 无锁地判断一个字是否已被记为脏
+    dirty_set m_dirty;
+    std::unique_ptr<std::mutex> m_dirty_lock; ///< 保护m_dirty，每个字在两次写回之间只需加一次
+    std::unique_ptr<std::atomic<size_t>[]> m_cursors; ///< 各分配组next-fit的起点
+    size_t m_size = 0;
+};
+
+}
\ No newline at end of file
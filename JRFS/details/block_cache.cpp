@@ -0,0 +1,216 @@
+#include "block_cache.hpp"
+#include <utility>
+
+namespace jrfs {
+
+block_cache::block_cache(data_block* data, int n)
+    : m_view(data)
+    , m_size(n)
+{
+}
+
+block_cache::block_cache(const image_file* image, size_t offset, int n, size_t capacity)
+    : m_image(image)
+    , m_offset(offset)
+    , m_size(n)
+    , m_capacity(capacity)
+    , m_frames(new std::atomic<frame*>[n])
+    , m_load_lock(new std::mutex)
+{
+    for (int i = 0; i < n; ++i)
+        m_frames[i].store(nullptr, std::memory_order_relaxed);
+}
+
+block_cache::block_cache(block_cache&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+block_cache& block_cache::operator=(block_cache&& other) noexcept
+{
+    for (frame* f : m_ring)
+        delete f;
+
+    m_view = std::exchange(other.m_view, nullptr);
+    m_image = std::exchange(other.m_image, nullptr);
+    m_offset = std::exchange(other.m_offset, 0);
+    m_size = std::exchange(other.m_size, 0);
+    m_capacity = std::exchange(other.m_capacity, 0);
+    m_frames = std::move(other.m_frames);
+    m_ring = std::move(other.m_ring);
+    other.m_ring.clear();
+    m_load_lock = std::move(other.m_load_lock);
+    m_resident.store(other.m_resident.exchange(0));
+    m_hits.store(other.m_hits.exchange(0));
+    m_misses.store(other.m_misses.exchange(0));
+    m_prefetches.store(other.m_prefetches.exchange(0));
+    m_evictions = std::exchange(other.m_evictions, 0);
+    return *this;
+}
+
+block_cache::~block_cache()
+{
+    for (frame* f : m_ring)
+        delete f;
+}
+
+data_block& block_cache::operator[](int id)
+{
+    return const_cast<data_block&>(std::as_const(*this)[id]);
+}
+
+const data_block& block_cache::operator[](int id) const
+{
+    if (m_view != nullptr)
+        return m_view[id];
+
+    frame* f = m_frames[id].load(std::memory_order_acquire);
+    if (f == nullptr) {
+        f = load(id);
+    } else {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        if (!f->referenced.load(std::memory_order_relaxed)) // Avoid Bouncing The Cache Line On Every Hit.
+            f->referenced.store(true, std::memory_order_relaxed);
+    }
+    return f->block;
+}
+
+block_cache::frame* block_cache::load(int id) const
+{
+    std::lock_guard lock(*m_load_lock);
+    frame* f = m_frames[id].load(std::memory_order_acquire);
+    if (f != nullptr) // Loaded By Another Thread Meanwhile.
+        return f;
+
+    auto fresh = std::make_unique<frame>();
+    fresh->id = id;
+    m_image->read(m_offset + static_cast<size_t>(id) * sizeof(data_block), &fresh->block, sizeof(data_block));
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+
+    f = fresh.get();
+    admit(std::move(fresh));
+    return f;
+}
+
+void block_cache::admit(std::unique_ptr<frame> fresh) const
+{
+    m_ring.push_back(fresh.get());
+    m_resident.fetch_add(1, std::memory_order_relaxed);
+    m_frames[fresh->id].store(fresh.release(), std::memory_order_release);
+}
+
+data_block& block_cache::zeroed(int id)
+{
+    if (m_view != nullptr)
+        return m_view[id] = data_block {};
+
+    std::lock_guard lock(*m_load_lock);
+    if (frame* f = m_frames[id].load(std::memory_order_acquire))
+        return f->block = data_block {};
+
+    auto fresh = std::make_unique<frame>(); // Value-Initialized, So Zeroed. Nothing On Disk Is Worth Reading.
+    fresh->id = id;
+    data_block& block = fresh->block;
+    admit(std::move(fresh));
+    return block;
+}
+
+void block_cache::prefetch(io_engine& io, const std::vector<int>& ids) const
+{
+    if (m_view != nullptr)
+        return;
+
+    std::vector<int> missing;
+    for (int id : ids)
+        if (m_frames[id].load(std::memory_order_acquire) == nullptr)
+            missing.push_back(id);
+    if (missing.empty())
+        return;
+
+    // Frames Are Separate Allocations, So Stage Each Contiguous Run In One Buffer And Read It In One Request.
+    std::vector<data_block> staging(missing.size());
+    std::vector<io_request> requests;
+    for (size_t i = 0; i < missing.size(); ++i) {
+        if (i > 0 && missing[i] == missing[i - 1] + 1) {
+            requests.back().length += sizeof(data_block);
+            continue;
+        }
+        requests.push_back({ false, m_offset + static_cast<size_t>(missing[i]) * sizeof(data_block), &staging[i], sizeof(data_block) });
+    }
+    io.run(requests);
+
+    std::lock_guard lock(*m_load_lock);
+    for (size_t i = 0; i < missing.size(); ++i) {
+        const int id = missing[i];
+        if (m_frames[id].load(std::memory_order_relaxed) != nullptr) // Loaded On Demand Meanwhile.
+            continue;
+        auto fresh = std::make_unique<frame>();
+        fresh->id = id;
+        fresh->block = staging[i];
+        admit(std::move(fresh));
+        m_prefetches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void block_cache::evict(frame*& slot)
+{
+    m_frames[slot->id].store(nullptr, std::memory_order_relaxed);
+    delete slot;
+    slot = nullptr;
+    m_resident.fetch_sub(1, std::memory_order_relaxed);
+    ++m_evictions;
+}
+
+size_t block_cache::size() const
+{
+    return m_size;
+}
+
+bool block_cache::is_view() const
+{
+    return m_view != nullptr;
+}
+
+bool block_cache::resident(int id) const
+{
+    return m_view != nullptr || m_frames[id].load(std::memory_order_acquire) != nullptr;
+}
+
+size_t block_cache::resident_count() const
+{
+    if (m_view != nullptr)
+        return m_size;
+    return m_resident.load(std::memory_order_relaxed);
+}
+
+size_t block_cache::capacity() const
+{
+    return m_capacity;
+}
+
+bool block_cache::over_capacity() const
+{
+    return m_capacity != 0 && resident_count() > m_capacity;
+}
+
+size_t block_cache::hits() const
+{
+    return m_hits.load(std::memory_order_relaxed);
+}
+
+size_t block_cache::misses() const
+{
+    return m_misses.load(std::memory_order_relaxed);
+}
+
+size_t block_cache::prefetches() const
+{
+    return m_prefetches.load(std::memory_order_relaxed);
+}
+
+size_t block_cache::evictions() const
+{
+    return m_evictions;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "data_block.hpp"
+#include "image_file.hpp"
+#include "io_engine.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace jrfs {
+
+/// \brief 数据块区的访问入口，有两种形态：
+/// mmap映射镜像时只是映射区的视图；否则是按需从镜像读入数据块的有界缓存，超出容量时以CLOCK算法淘汰。
+/// 命中时无锁；未命中时加锁读入。淘汰只在trim()中进行，调用者须保证此时没有其他线程持有或访问数据块。
+class block_cache {
+public:
+    block_cache() = default;
+
+    /// \brief 构造映射区的视图，不缓存也不淘汰
+    /// \param data 映射区中数据块区的首地址
+    /// \param n 数据块个数
+    block_cache(data_block* data, int n);
+
+    /// \brief 构造按需读入的缓存
+    /// \param image 镜像文件，须比缓存存活得久
+    /// \param offset 数据块区在镜像中的偏移
+    /// \param n 数据块个数
+    /// \param capacity 常驻数据块个数的上限，0表示不限
+    block_cache(const image_file* image, size_t offset, int n, size_t capacity);
+
+    block_cache(block_cache&& other) noexcept;
+    block_cache& operator=(block_cache&& other) noexcept;
+
+    ~block_cache();
+
+    /// \throws std::logic_error 读入失败时抛出
+    /// \param id 数据块下标
+    /// \return 数据块，不常驻时先从镜像读入；引用在下一次trim()之前有效
+    data_block& operator[](int id);
+    const data_block& operator[](int id) const;
+
+    /// \param id 数据块下标
+    /// \return 清零后的数据块。不常驻时直接建立全零的frame而不读镜像，用于刚分配、原有内容作废的数据块
+    data_block& zeroed(int id);
+
+    /// \throws std::logic_error 读入失败时抛出
+    /// \param io 用于批量读入的I/O引擎
+    /// \param ids 数据块下标，物理上连续的部分合并为一次读
+    /// \brief 将尚未常驻的数据块批量读入缓存；读入期间不持锁，按需读入可照常进行。视图形态下什么也不做
+    void prefetch(io_engine& io, const std::vector<int>& ids) const;
+
+    /// \return 数据块个数
+    size_t size() const;
+
+    /// \return 是否只是映射区的视图
+    bool is_view() const;
+
+    /// \param id 数据块下标
+    /// \return 数据块是否常驻内存
+    bool resident(int id) const;
+
+    /// \return 常驻的数据块个数
+    size_t resident_count() const;
+
+    /// \return 常驻数据块个数的上限，0表示不限
+    size_t capacity() const;
+
+    /// \return 常驻数据块超出容量上限
+    bool over_capacity() const;
+
+    /// \return 命中、未命中、预读与淘汰的次数
+    size_t hits() const;
+    size_t misses() const;
+    size_t prefetches() const;
+    size_t evictions() const;
+
+    /// \param can_evict 回调，参数为数据块下标，返回假的数据块本轮不被淘汰（如尚未提交的脏块）
+    /// \param write_back 回调，参数为将被淘汰的数据块下标及其内容，须在返回前将其写回（如果是脏的）
+    /// \brief 按CLOCK算法淘汰数据块，直到常驻个数降到容量的7/8；最近被访问过的块获得第二次机会
+    template <typename F, typename G>
+    void trim(F&& can_evict, G&& write_back);
+
+private:
+    struct frame {
+        data_block block;
+        int id;
+        std::atomic<bool> referenced { true };
+    };
+
+    /// \brief 未命中时读入数据块
+    frame* load(int id) const;
+
+    /// \brief 将新frame加入环与映射，调用者须持有m_load_lock
+    void admit(std::unique_ptr<frame> fresh) const;
+
+    /// \brief 释放frame并将环中的槽位置空，由trim()最后统一清理
+    void evict(frame*& slot);
+
+    data_block* m_view = nullptr;
+    const image_file* m_image = nullptr;
+    size_t m_offset = 0;
+    int m_size = 0;
+    size_t m_capacity = 0;
+
+    std::unique_ptr<std::atomic<frame*>[]> m_frames; ///< 数据块下标到常驻frame的映射，不常驻为nullptr
+    mutable std::vector<frame*> m_ring; ///< CLOCK的环，指针始终在开头，新读入的frame追加在末尾即指针之后
+    mutable std::unique_ptr<std::mutex> m_load_lock; ///< 保护读入与m_ring
+    mutable std::atomic<size_t> m_resident { 0 }; ///< 即m_ring中非空的槽数，判断是否超出容量时无需加锁
+    mutable std::atomic<size_t> m_hits { 0 }, m_misses { 0 }, m_prefetches { 0 };
+    size_t m_evictions = 0;
+};
+
+template <typename F, typename G>
+void block_cache::trim(F&& can_evict, G&& write_back)
+{
+    if (m_view != nullptr || m_capacity == 0 || m_ring.size() <= m_capacity)
+        return;
+
+    // Trim Below The Capacity, So The Next Trim Is Not Right After The Next Miss.
+    const size_t target = m_capacity - m_capacity / 8;
+    size_t resident = m_ring.size();
+    size_t hand = 0;
+    for (size_t scanned = 0; resident > target && scanned < 2 * m_ring.size(); ++scanned, hand = (hand + 1) % m_ring.size()) {
+        frame*& f = m_ring[hand];
+        if (f == nullptr || f->referenced.exchange(false, std::memory_order_relaxed) || !can_evict(f->id))
+            continue;
+        write_back(f->id, f->block);
+        evict(f);
+        --resident;
+    }
+
+    // Bring The Hand Back To The Front, So Blocks Loaded From Now On Wait A Whole Sweep Before Eviction.
+    std::rotate(m_ring.begin(), m_ring.begin() + hand, m_ring.end());
+    m_ring.erase(std::remove(m_ring.begin(), m_ring.end(), nullptr), m_ring.end());
+}
+
+}
\ No newline at end of file
@@ -3,9 +3,20 @@
 namespace jrfs {
 
 constexpr int kBlockSize = 512;
-constexpr int kSuperBlockSize = 12;
+constexpr int kSuperBlockSize = 36;
+constexpr int kHeaderSize = kBlockSize; ///< 镜像头部（super block）所占区域，保证后续inode区与数据块区对齐
 constexpr int kInodeSize = 128;
 
 constexpr int kNULL = 0;
 constexpr float kInodePercent = 0.1;
+constexpr float kJournalPercent = 0.05; ///< 日志区占数据块总数的比例
+constexpr int kMinJournalBlocks = 16; ///< 日志区至少所占的数据块个数
+constexpr int kMinReadahead = 16; ///< 顺序读取时预读窗口的初始数据块个数
+constexpr int kMaxReadahead = 1024; ///< 预读窗口的最大数据块个数
+#ifdef JRFS_METRICS
+constexpr bool kMetricsEnabled = true; ///< 是否收集运行统计，由编译选项JRFS_METRICS决定
+#else
+constexpr bool kMetricsEnabled = false; ///< 是否收集运行统计，由编译选项JRFS_METRICS决定
+#endif
+constexpr int kWriteBufferBlocks = 8; ///< 句柄写缓冲区攒满这么多个数据块的数据后才写入文件
 }
\ No newline at end of file
@@ -4,17 +4,13 @@
 namespace jrfs {
 
 void data_block::read(std::fstream& fstream)
-{
-    llread(fstream, next);
-    llread(fstream, size);
-    llread(fstream, data_content);
+{ // The In-Memory Layout Is Exactly The On-Disk Layout (Checked By The Super Block), So Transfer It At Once.
+    llread(fstream, *this);
 }
 
 void data_block::write(std::fstream& fstream) const
 {
-    llwrite(fstream, next);
-    llwrite(fstream, size);
-    llwrite(fstream, data_content);
+    llwrite(fstream, *this);
 }
 
 }
\ No newline at end of file
@@ -3,14 +3,14 @@
 #include "config.hpp"
 
 #include <fstream>
+#include <type_traits>
 
 namespace jrfs {
 
 /// \brief 数据块的内存映像
 struct data_block {
-    static constexpr int kContentSize = kBlockSize - sizeof(int) * 2; ///> 数据块最大容量
+    static constexpr int kContentSize = kBlockSize - sizeof(int); ///> 数据块最大容量
 
-    int next = kNULL; ///< 后继数据块节点
     int size = 0; ///< 数据块大小
     char data_content[kContentSize]; ///> 数据块内容
 
@@ -24,5 +24,6 @@ struct data_block {
 };
 
 static_assert(sizeof(data_block) == kBlockSize, "Block Size Is not 512!");
+static_assert(std::is_trivially_copyable_v<data_block>, "Blocks Are Read & Written As Raw Bytes!");
 
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "dentry_cache.hpp"
+#include "dir_bucket.hpp"
+
+namespace jrfs {
+
+bool dentry_cache::key::operator==(const key& other) const
+{
+    return parent == other.parent && std::strncmp(name, other.name, sizeof(name)) == 0;
+}
+
+size_t dentry_cache::key_hash::operator()(const key& k) const
+{
+    return dir_bucket::hash(k.name) * 31u + static_cast<uint32_t>(k.parent);
+}
+
+bool dentry_cache::make_key(int parent, std::string_view name, key& k)
+{
+    if (name.size() >= sizeof(k.name))
+        return false;
+
+    k.parent = parent;
+    std::memset(k.name, 0, sizeof(k.name));
+    name.copy(k.name, name.size());
+    return true;
+}
+
+int dentry_cache::lookup(int parent, std::string_view name)
+{
+    key k;
+    if (make_key(parent, name, k)) {
+        std::shared_lock lock(m_lock);
+        const auto it = m_entries.find(k);
+        if (it != m_entries.end()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return -1;
+}
+
+void dentry_cache::insert(int parent, std::string_view name, int inode_id)
+{
+    key k;
+    if (!make_key(parent, name, k))
+        return;
+    std::lock_guard lock(m_lock);
+    if (m_entries.size() >= kMaxEntries)
+        m_entries.clear();
+    m_entries[k] = inode_id;
+}
+
+void dentry_cache::erase(int parent, std::string_view name, std::string_view parent_path)
+{
+    std::string path(parent_path);
+    if (path.empty() || path.back() != '/')
+        path += '/';
+    path += name;
+
+    std::lock_guard lock(m_lock);
+    key k;
+    if (make_key(parent, name, k))
+        m_entries.erase(k);
+
+    // Everything Starting With The Path Sorts Right After It; Only Drop The Path Itself And What Lies Below It.
+    for (auto it = m_paths.lower_bound(path); it != m_paths.end() && it->first.compare(0, path.size(), path) == 0;) {
+        if (it->first.size() == path.size() || it->first[path.size()] == '/')
+            it = m_paths.erase(it);
+        else
+            ++it;
+    }
+}
+
+int dentry_cache::lookup_path(std::string_view path)
+{
+    std::shared_lock lock(m_lock);
+    const auto it = m_paths.find(path);
+    if (it == m_paths.end()) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return it->second;
+}
+
+void dentry_cache::insert_path(std::string_view path, int inode_id)
+{
+    std::lock_guard lock(m_lock);
+    const auto it = m_paths.find(path);
+    if (it != m_paths.end()) {
+        it->second = inode_id;
+        return;
+    }
+
+    if (m_paths.size() >= kMaxEntries)
+        m_paths.clear();
+    m_paths.emplace(path, inode_id);
+}
+
+void dentry_cache::clear()
+{
+    std::lock_guard lock(m_lock);
+    m_entries.clear();
+    m_paths.clear();
+}
+
+size_t dentry_cache::hits() const
+{
+    return m_hits.load(std::memory_order_relaxed);
+}
+
+size_t dentry_cache::misses() const
+{
+    return m_misses.load(std::memory_order_relaxed);
+}
+
+}
\ No newline at end of file
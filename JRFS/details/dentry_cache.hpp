@@ -0,0 +1,77 @@
+#pragma once
+
+#include "inode.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace jrfs {
+
+/// \brief 路径查找缓存：缓存(父文件夹, 名字)到inode下标的映射，以及完整路径到inode下标的映射。
+/// 只缓存查找成功的结果；目录项被移除时须调用erase使其失效。各方法均可被并发调用，查找只加共享锁。
+class dentry_cache {
+public:
+    static constexpr size_t kMaxEntries = 1 << 16; ///< 每张表的容量上限，超出时整表清空
+
+    /// \param parent 父文件夹inode下标
+    /// \param name 名字
+    /// \return 子节点的inode下标，未命中则返回-1
+    int lookup(int parent, std::string_view name);
+
+    /// \param parent 父文件夹inode下标
+    /// \param name 名字
+    /// \param inode_id 子节点的inode下标
+    void insert(int parent, std::string_view name, int inode_id);
+
+    /// \param parent 父文件夹inode下标
+    /// \param name 名字
+    /// \param parent_path 父文件夹的完整路径
+    /// \brief 使该目录项，以及以它的完整路径为前缀（即经过它）的完整路径失效
+    void erase(int parent, std::string_view name, std::string_view parent_path);
+
+    /// \param path 完整路径
+    /// \return inode下标，未命中则返回-1
+    int lookup_path(std::string_view path);
+
+    /// \param path 完整路径
+    /// \param inode_id inode下标
+    void insert_path(std::string_view path, int inode_id);
+
+    /// \brief 清空缓存（计数器保留）
+    void clear();
+
+    /// \return 命中次数
+    size_t hits() const;
+
+    /// \return 未命中次数
+    size_t misses() const;
+
+private:
+    /// \brief 定长的键，查找时无需堆分配
+    struct key {
+        int parent;
+        char name[sizeof(inode::name)];
+
+        bool operator==(const key& other) const;
+    };
+
+    struct key_hash {
+        size_t operator()(const key& k) const;
+    };
+
+    /// \return 名字过长（不可能存在）时返回false
+    static bool make_key(int parent, std::string_view name, key& k);
+
+    std::unordered_map<key, int, key_hash> m_entries;
+    std::map<std::string, int, std::less<>> m_paths; ///< 有序，经过同一目录项的路径相邻，可按前缀成段删除；透明比较器使查找无需构造std::string
+    mutable std::shared_mutex m_lock;
+    std::atomic<size_t> m_hits { 0 };
+    std::atomic<size_t> m_misses { 0 };
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "dir_bucket.hpp"
+
+#include <cstring>
+
+namespace jrfs {
+
+dir_bucket dir_bucket::load(const data_block& block)
+{
+    dir_bucket bucket;
+    std::memcpy(&bucket, block.data_content, sizeof(bucket));
+    return bucket;
+}
+
+void dir_bucket::store(data_block& block) const
+{
+    std::memcpy(block.data_content, this, sizeof(*this));
+    block.size = 0; // Not File Content.
+}
+
+int dir_bucket::find(std::string_view name) const
+{
+    for (int i = 0; i < count; ++i)
+        if (entries[i].view() == name)
+            return i;
+    return -1;
+}
+
+uint32_t dir_bucket::hash(std::string_view name)
+{
+    uint32_t h = 2166136261u;
+    for (unsigned char c : name)
+        h = (h ^ c) * 16777619u;
+    return h;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "data_block.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+namespace jrfs {
+
+/// \brief 目录项：子文件/子文件夹的名字与inode下标
+struct dir_entry {
+    int inode_id; ///< 子节点的inode下标
+    char name[32]; ///< 子节点的名字，与inode::name一致
+
+    /// \return 名字
+    inline std::string_view view() const { return { name }; }
+};
+
+/// \brief 目录哈希表的桶，存放于一个数据块的data_content中。
+/// 桶写满后通过next链接溢出块。
+struct dir_bucket {
+    static constexpr int kBucketHeaderSize = sizeof(int) * 2;
+    static constexpr int kMaxEntries = (data_block::kContentSize - kBucketHeaderSize) / sizeof(dir_entry); ///< 每个块最多存放的目录项数
+
+    int next = kNULL; ///< 溢出块的数据块下标
+    int count = 0; ///< 有效项的个数
+    dir_entry entries[kMaxEntries];
+
+    /// \param block 存放桶的数据块
+    /// \return 数据块中的桶
+    static dir_bucket load(const data_block& block);
+
+    /// \param block 存放桶的数据块
+    /// \brief 将桶写入数据块
+    void store(data_block& block) const;
+
+    /// \param name 名字
+    /// \return 名字为name的项的下标，不存在则返回-1
+    int find(std::string_view name) const;
+
+    /// \param name 名字
+    /// \return 名字的哈希值（FNV-1a）
+    static uint32_t hash(std::string_view name);
+};
+
+static_assert(sizeof(dir_bucket) <= data_block::kContentSize, "A Directory Bucket Must Fit In A Block!");
+
+}
\ No newline at end of file
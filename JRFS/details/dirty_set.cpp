@@ -0,0 +1,41 @@
+#include "dirty_set.hpp"
+
+namespace jrfs {
+
+void dirty_set::resize(int n)
+{
+    m_flags.assign(n, false);
+    m_indexes.clear();
+}
+
+void dirty_set::mark(int index)
+{
+    if (!m_flags[index]) {
+        m_flags[index] = true;
+        m_indexes.push_back(index);
+    }
+}
+
+bool dirty_set::contains(int index) const
+{
+    return m_flags[index];
+}
+
+size_t dirty_set::size() const
+{
+    return m_indexes.size();
+}
+
+bool dirty_set::empty() const
+{
+    return m_indexes.empty();
+}
+
+void dirty_set::clear()
+{
+    for (int index : m_indexes)
+        m_flags[index] = false;
+    m_indexes.clear();
+}
+
+}
\ No newline at end of file
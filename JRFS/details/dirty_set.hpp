@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace jrfs {
+
+/// \brief 记录被修改过（需要写回镜像）的下标集合
+class dirty_set {
+public:
+    /// \param n 下标总数
+    /// \brief 重新设置下标范围，并清空集合
+    void resize(int n);
+
+    /// \param index 被修改的下标
+    /// \brief 标记一个下标为脏，重复标记只记录一次
+    void mark(int index);
+
+    /// \return 下标是否为脏
+    bool contains(int index) const;
+
+    /// \return 脏下标的个数
+    size_t size() const;
+
+    /// \return 是否没有脏下标
+    bool empty() const;
+
+    /// \brief 清空集合
+    void clear();
+
+    /// \param fn 回调，参数为一段连续脏下标的起点和长度
+    /// \brief 按下标升序，将连续的脏下标合并成段后依次回调，便于合并写回
+    template <typename F>
+    void for_each_run(F&& fn)
+    {
+        std::sort(m_indexes.begin(), m_indexes.end());
+        for (size_t i = 0; i < m_indexes.size();) {
+            size_t j = i + 1;
+            while (j < m_indexes.size() && m_indexes[j] == m_indexes[j - 1] + 1)
+                ++j;
+            fn(m_indexes[i], static_cast<int>(j - i));
+            i = j;
+        }
+    }
+
+private:
+    std::vector<char> m_flags;
+    std::vector<int> m_indexes;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "extent.hpp"
+
+#include <cstring>
+
+namespace jrfs {
+
+extent_node extent_node::load(const data_block& block)
+{
+    extent_node node;
+    std::memcpy(&node, block.data_content, sizeof(node));
+    return node;
+}
+
+void extent_node::store(data_block& block) const
+{
+    std::memcpy(block.data_content, this, sizeof(*this));
+    block.size = 0; // Not File Content.
+}
+
+int extent_node::find(int nth) const
+{
+    int lo = 0, hi = count; // Binary Search The First Entry Beginning After `nth`.
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const int logical = depth == 0 ? extents[mid].logical : children[mid].logical;
+        if (logical <= nth)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo - 1;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "data_block.hpp"
+
+namespace jrfs {
+
+/// \brief 一段逻辑上与物理上都连续的数据块
+struct extent {
+    int logical; ///< 第一个块在文件中的逻辑块号
+    int start; ///< 第一个块的数据块下标
+    int length; ///< 连续的块数
+};
+
+/// \brief extent树中间节点指向子节点的项
+struct extent_index {
+    int logical; ///< 子树覆盖的第一个逻辑块号
+    int child; ///< 子节点所在的数据块下标
+};
+
+/// \brief 文件extent树的节点，存放于一个数据块的data_content中。
+/// 叶子节点存放extent，中间节点存放子节点索引，均按逻辑块号升序排列。
+struct extent_node {
+    static constexpr int kNodeHeaderSize = sizeof(int) * 2;
+    static constexpr int kMaxExtents = (data_block::kContentSize - kNodeHeaderSize) / sizeof(extent); ///< 叶子节点最多存放的extent数
+    static constexpr int kMaxChildren = (data_block::kContentSize - kNodeHeaderSize) / sizeof(extent_index); ///< 中间节点最多存放的子节点数
+
+    int depth = 0; ///< 节点高度，叶子节点为0
+    int count = 0; ///< 有效项的个数
+    union {
+        extent extents[kMaxExtents];
+        extent_index children[kMaxChildren];
+    };
+
+    /// \param block 存放节点的数据块
+    /// \return 数据块中的节点
+    static extent_node load(const data_block& block);
+
+    /// \param block 存放节点的数据块
+    /// \brief 将节点写入数据块
+    void store(data_block& block) const;
+
+    /// \param nth 逻辑块号
+    /// \return 最后一个起始逻辑块号不大于nth的项的下标，不存在则返回-1
+    int find(int nth) const;
+};
+
+static_assert(sizeof(extent_node) <= data_block::kContentSize, "An Extent Node Must Fit In A Block!");
+
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "image_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace jrfs {
+
+static std::string errno_message()
+{
+    return std::string(" (") + std::strerror(errno) + ")";
+}
+
+image_file::image_file(const std::string& path, bool create)
+    : m_path(path)
+{
+    int flags = O_RDWR;
+    if (create)
+        flags |= O_CREAT | O_TRUNC;
+
+    m_fd = ::open(path.c_str(), flags, 0644);
+    if (m_fd < 0)
+        throw std::logic_error("Cannot Open Image File: " + path + errno_message());
+}
+
+image_file::image_file(image_file&& other) noexcept
+    : m_path(std::move(other.m_path))
+    , m_fd(std::exchange(other.m_fd, -1))
+    , m_map(std::exchange(other.m_map, nullptr))
+    , m_map_size(std::exchange(other.m_map_size, 0))
+{
+}
+
+image_file& image_file::operator=(image_file&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_path = std::move(other.m_path);
+        m_fd = std::exchange(other.m_fd, -1);
+        m_map = std::exchange(other.m_map, nullptr);
+        m_map_size = std::exchange(other.m_map_size, 0);
+    }
+    return *this;
+}
+
+image_file::~image_file()
+{
+    close();
+}
+
+void image_file::close()
+{
+    if (m_map != nullptr)
+        ::munmap(m_map, m_map_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_map = nullptr;
+    m_map_size = 0;
+    m_fd = -1;
+}
+
+void image_file::resize(size_t bytes)
+{
+    if (m_map != nullptr)
+        throw std::logic_error("Cannot Resize A Mapped Image: " + m_path);
+    if (::ftruncate(m_fd, bytes) != 0)
+        throw std::logic_error("Cannot Resize Image File: " + m_path + errno_message());
+}
+
+size_t image_file::size() const
+{
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0)
+        throw std::logic_error("Cannot Stat Image File: " + m_path + errno_message());
+    return st.st_size;
+}
+
+void image_file::read(size_t offset, void* data, size_t length) const
+{
+    auto dst = static_cast<char*>(data);
+    while (length > 0) {
+        ssize_t n = ::pread(m_fd, dst, length, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::logic_error("Cannot Read From Image File: " + m_path + (n == 0 ? std::string(" (Unexpected EOF)") : errno_message()));
+        dst += n;
+        offset += n;
+        length -= n;
+    }
+}
+
+void image_file::write(size_t offset, const void* data, size_t length)
+{
+    auto src = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t n = ::pwrite(m_fd, src, length, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            throw std::logic_error("Cannot Write To Image File: " + m_path + errno_message());
+        src += n;
+        offset += n;
+        length -= n;
+    }
+}
+
+void image_file::flush()
+{
+    if (::fdatasync(m_fd) != 0)
+        throw std::logic_error("Cannot Flush Image File: " + m_path + errno_message());
+}
+
+char* image_file::map()
+{
+    if (m_map != nullptr)
+        return m_map;
+
+    m_map_size = size();
+    void* addr = ::mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (addr == MAP_FAILED)
+        throw std::logic_error("Cannot Map Image File: " + m_path + errno_message());
+
+    m_map = static_cast<char*>(addr);
+    return m_map;
+}
+
+void image_file::sync(size_t offset, size_t length)
+{
+    if (m_map == nullptr || length == 0)
+        return;
+
+    // msync() Requires A Page Aligned Address.
+    static const size_t page_size = ::sysconf(_SC_PAGESIZE);
+    const size_t begin = offset / page_size * page_size;
+    const size_t end = std::min(offset + length, m_map_size);
+    if (begin >= end)
+        return;
+
+    if (::msync(m_map + begin, end - begin, MS_SYNC) != 0)
+        throw std::logic_error("Cannot Sync Image File: " + m_path + errno_message());
+}
+
+}
\ No newline at end of file
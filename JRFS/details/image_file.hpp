@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace jrfs {
+
+/// \brief 一级文件系统中的镜像文件（POSIX文件描述符 + 可选的共享内存映射）
+class image_file {
+public:
+    image_file() = default;
+
+    /// \throws std::logic_error
+    /// \param path 镜像路径
+    /// \param create 若为真则创建（并清空）镜像文件
+    image_file(const std::string& path, bool create);
+
+    image_file(image_file&& other) noexcept;
+    image_file& operator=(image_file&& other) noexcept;
+
+    image_file(const image_file&) = delete;
+    image_file& operator=(const image_file&) = delete;
+
+    /// \brief 解除映射并关闭文件
+    ~image_file();
+
+    /// \throws std::logic_error
+    /// \param bytes 镜像文件的新大小（新增部分以0填充）
+    void resize(size_t bytes);
+
+    /// \throws std::logic_error
+    /// \return 镜像文件当前大小
+    size_t size() const;
+
+    /// \throws std::logic_error
+    /// \param offset 镜像中的偏移
+    /// \param data 读出数据的目标地址
+    /// \param length 字节数
+    /// \brief 从镜像的固定偏移处读出数据（pread）
+    void read(size_t offset, void* data, size_t length) const;
+
+    /// \throws std::logic_error
+    /// \param offset 镜像中的偏移
+    /// \param data 被写入的数据
+    /// \param length 字节数
+    /// \brief 向镜像的固定偏移处写入数据（pwrite）
+    void write(size_t offset, const void* data, size_t length);
+
+    /// \throws std::logic_error
+    /// \brief 将此前通过write()写入的数据落盘（fdatasync）
+    void flush();
+
+    /// \throws std::logic_error
+    /// \brief 将整个镜像以MAP_SHARED方式映射进内存
+    /// \return 映射首地址
+    char* map();
+
+    /// \throws std::logic_error
+    /// \param offset 起始偏移
+    /// \param length 字节数
+    /// \brief 将映射中[offset, offset + length)所在的页同步回磁盘
+    void sync(size_t offset, size_t length);
+
+    /// \return 映射首地址，未映射时为nullptr
+    inline char* mapping() const
+    {
+        return m_map;
+    }
+
+    /// \return 文件描述符
+    inline int fd() const
+    {
+        return m_fd;
+    }
+
+private:
+    void close();
+
+    std::string m_path;
+    int m_fd = -1;
+    char* m_map = nullptr;
+    size_t m_map_size = 0;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "data_block.hpp"
+
+#include <cstring>
+
+namespace jrfs {
+
+/// \brief 间接索引块：将整个数据块视为kIdsPerBlock个数据块下标
+struct index_block {
+    static constexpr int kIdsPerBlock = kBlockSize / sizeof(int); ///< 每个间接索引块可存放的下标个数
+
+    /// \param block 间接索引块
+    /// \param i 第i项
+    /// \return 第i项存放的数据块下标
+    static inline int get(const data_block& block, int i)
+    {
+        int id;
+        std::memcpy(&id, reinterpret_cast<const char*>(&block) + i * sizeof(int), sizeof(int));
+        return id;
+    }
+
+    /// \param block 间接索引块
+    /// \param i 第i项
+    /// \param id 数据块下标
+    static inline void set(data_block& block, int i, int id)
+    {
+        std::memcpy(reinterpret_cast<char*>(&block) + i * sizeof(int), &id, sizeof(int));
+    }
+};
+
+}
\ No newline at end of file
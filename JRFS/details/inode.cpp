@@ -19,25 +19,13 @@ bool inode::is_dir() const
 }
 
 void inode::write(std::fstream& fstream)
-{
-    llwrite(fstream, valid);
-    llwrite(fstream, size);
-    llwrite(fstream, is_directory);
-    llwrite(fstream, name);
-    llwrite(fstream, unix_time);
-    for (auto&& db : direct_block)
-        llwrite(fstream, db);
+{ // The In-Memory Layout Is Exactly The On-Disk Layout (Checked By The Super Block), So Transfer It At Once.
+    llwrite(fstream, *this);
 }
 
 void inode::read(std::fstream& fstream)
 {
-    llread(fstream, valid);
-    llread(fstream, size);
-    llread(fstream, is_directory);
-    llread(fstream, name);
-    llread(fstream, unix_time);
-    for (auto&& db : direct_block)
-        llread(fstream, db);
+    llread(fstream, *this);
 }
 
 }
\ No newline at end of file
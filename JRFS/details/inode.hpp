@@ -5,13 +5,14 @@
 #include <array>
 #include <cassert>
 #include <ctime>
+#include <type_traits>
 
 namespace jrfs {
 
 /// \brief 文件描述节点（文件元数据）
 struct alignas(kInodeSize) inode {
     int valid = kNULL; ///< 是否当前inode正在被使用
-    int size = 0; ///< inode数据的逻辑字节大小
+    int size = 0; ///< inode数据的逻辑字节大小；文件夹则为目录项个数
     int is_directory = false; ///> 是否是文件夹
 
     char name[32] = ""; ///< 文件名
@@ -23,34 +24,34 @@ public:
     /// \return 是否是文件夹
     bool is_dir() const;
 
-    /// \brief 查找当前所在文件夹
+    /// \brief 查找当前所在文件夹（根目录所在的文件夹为其自身）
     /// \return 当前文件夹下标
     inline int& current_dir()
     {
         return direct_block[0];
     }
 
-    /// \brief 上一级文件夹
+    /// \brief 上一级文件夹，即文件夹所在的文件夹
     /// \return 上一级文件夹下标
     inline int& last_level_dir()
     {
         assert(is_directory);
-        return direct_block[1];
+        return direct_block[0];
     }
 
-    /// \brief 查找当前所在文件夹
+    /// \brief 查找当前所在文件夹（根目录所在的文件夹为其自身）
     /// \return 当前文件夹下标
     inline const int& current_dir() const
     {
         return direct_block[0];
     }
 
-    /// \brief 上一级文件夹
+    /// \brief 上一级文件夹，即文件夹所在的文件夹
     /// \return 上一级文件夹下标
     inline const int& last_level_dir() const
     {
         assert(is_directory);
-        return direct_block[1];
+        return direct_block[0];
     }
 
     /// \param istream 文件系统镜像流
@@ -65,5 +66,6 @@ public:
 inode make_empty_dir();
 
 static_assert(sizeof(inode) == kInodeSize, "A inode must be less than or equal to 128 bytes.");
+static_assert(std::is_trivially_copyable_v<inode>, "Inodes Are Read & Written As Raw Bytes!");
 
 }
\ No newline at end of file
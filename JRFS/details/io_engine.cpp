@@ -0,0 +1,463 @@
+#include "io_engine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace jrfs {
+
+namespace {
+
+    /// \brief 一批请求的完成状态，最后一段完成时兑现promise
+    struct io_batch {
+        std::promise<void> done;
+        std::atomic<size_t> remaining { 0 };
+        std::mutex error_lock;
+        std::exception_ptr error;
+
+        void finish(std::exception_ptr err)
+        {
+            if (err) {
+                std::lock_guard lock(error_lock);
+                if (!error)
+                    error = err;
+            }
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+
+            std::lock_guard lock(error_lock);
+            if (error)
+                done.set_exception(error);
+            else
+                done.set_value();
+        }
+    };
+
+    /// \brief 拆分后的一段请求
+    struct io_piece {
+        std::shared_ptr<io_batch> batch;
+        io_request request;
+    };
+
+    /// \brief 以pread/pwrite同步完成一段请求，处理被信号打断与短读写
+    void transfer(int fd, io_request request)
+    {
+        auto data = static_cast<char*>(request.buffer);
+        while (request.length > 0) {
+            const ssize_t n = request.write ? ::pwrite(fd, data, request.length, request.offset) : ::pread(fd, data, request.length, request.offset);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                throw std::logic_error(std::string(request.write ? "Cannot Write To Image File" : "Cannot Read From Image File") + " (" + std::strerror(errno) + ")");
+            if (n == 0)
+                throw std::logic_error("Unexpected End Of Image File At " + std::to_string(request.offset));
+            data += n;
+            request.offset += n;
+            request.length -= n;
+        }
+    }
+
+    /// \brief 同步完成一段请求并报告给所属批次
+    void complete(io_piece* piece, int fd)
+    {
+        std::exception_ptr err;
+        try {
+            transfer(fd, piece->request);
+        } catch (...) {
+            err = std::current_exception();
+        }
+        piece->batch->finish(err);
+        delete piece;
+    }
+
+}
+
+class io_engine::impl {
+public:
+    explicit impl(int fd)
+        : m_fd(fd)
+    {
+    }
+    virtual ~impl() = default;
+
+    virtual io_backend backend() const = 0;
+
+    /// \brief 提交若干段请求，完成后各自调用batch->finish()
+    virtual void submit(std::vector<io_piece*>& pieces) = 0;
+
+protected:
+    const int m_fd;
+};
+
+namespace {
+
+    /// \brief 工作线程池：每个线程取出一段请求，以pread/pwrite完成
+    class pool_backend final : public io_engine::impl {
+    public:
+        explicit pool_backend(int fd)
+            : impl(fd)
+        {
+            const unsigned n = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+            for (unsigned i = 0; i < n; ++i)
+                m_workers.emplace_back([this] { work(); });
+        }
+
+        ~pool_backend() override
+        {
+            {
+                std::lock_guard lock(m_lock);
+                m_stopping = true;
+            }
+            m_ready.notify_all();
+            for (auto& worker : m_workers)
+                worker.join();
+        }
+
+        io_backend backend() const override
+        {
+            return io_backend::thread_pool;
+        }
+
+        void submit(std::vector<io_piece*>& pieces) override
+        {
+            {
+                std::lock_guard lock(m_lock);
+                m_queue.insert(m_queue.end(), pieces.begin(), pieces.end());
+            }
+            m_ready.notify_all();
+        }
+
+    private:
+        void work()
+        {
+            std::unique_lock lock(m_lock);
+            for (;;) {
+                m_ready.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_queue.empty()) // Stopping, And Everything Queued Is Done.
+                    return;
+                auto piece = m_queue.front();
+                m_queue.pop_front();
+                lock.unlock();
+                complete(piece, m_fd);
+                lock.lock();
+            }
+        }
+
+        std::mutex m_lock;
+        std::condition_variable m_ready;
+        std::deque<io_piece*> m_queue;
+        bool m_stopping = false;
+        std::vector<std::thread> m_workers;
+    };
+
+    /// \brief 直接通过系统调用使用io_uring：调用者线程填写提交队列，收割线程处理完成队列
+    class uring_backend final : public io_engine::impl {
+    public:
+        static constexpr unsigned kEntries = 64;
+
+        /// \throws std::logic_error 内核不支持io_uring时抛出
+        explicit uring_backend(int fd)
+            : impl(fd)
+        {
+            io_uring_params params {};
+            m_ring = static_cast<int>(::syscall(__NR_io_uring_setup, kEntries, &params));
+            if (m_ring < 0)
+                throw std::logic_error(std::string("io_uring Not Available (") + std::strerror(errno) + ")");
+            try {
+                setup(params);
+            } catch (...) { // Nothing Is In Flight Yet, So Only The Ring Itself Must Go.
+                release();
+                throw;
+            }
+        }
+
+        ~uring_backend() override
+        {
+            {
+                std::unique_lock lock(m_lock);
+                m_stopping = true;
+                make_room(lock);
+                push(IORING_OP_NOP, nullptr); // Wakes The Reaper Up.
+                enter(lock);
+            }
+            m_reaper.join();
+            release();
+        }
+
+        io_backend backend() const override
+        {
+            return io_backend::uring;
+        }
+
+        void submit(std::vector<io_piece*>& pieces) override
+        {
+            std::unique_lock lock(m_lock);
+            for (auto piece : pieces) {
+                // Never Have More In Flight Than The Completion Queue Holds.
+                if (m_in_flight == m_cq_entries) {
+                    enter(lock);
+                    m_drained.wait(lock, [this] { return m_in_flight < m_cq_entries; });
+                }
+                make_room(lock);
+                push(piece->request.write ? IORING_OP_WRITE : IORING_OP_READ, piece);
+                ++m_in_flight;
+            }
+            enter(lock);
+        }
+
+    private:
+        /// \throws std::logic_error 内核不支持所需操作或映射失败时抛出，由构造函数负责释放已取得的资源
+        /// \brief 检查内核支持的操作，映射提交队列与完成队列，启动收割线程
+        void setup(const io_uring_params& params)
+        {
+            if (!supports({ IORING_OP_READ, IORING_OP_WRITE })) // Rings Older Than 5.6 Only Know The Vectored Ones.
+                throw std::logic_error("io_uring Cannot Read Or Write");
+
+            m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_mmap)
+                m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+
+            m_sq_ring = map(m_sq_size, IORING_OFF_SQ_RING);
+            m_cq_ring = single_mmap ? m_sq_ring : map(m_cq_size, IORING_OFF_CQ_RING);
+            m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            m_sqes = static_cast<io_uring_sqe*>(map(m_sqes_size, IORING_OFF_SQES));
+
+            auto sq = static_cast<char*>(m_sq_ring);
+            m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            m_sq_entries = params.sq_entries;
+
+            auto cq = static_cast<char*>(m_cq_ring);
+            m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            m_cq_entries = params.cq_entries;
+
+            m_reaper = std::thread([this] { reap(); });
+        }
+
+        /// \brief 解除映射并关闭环，只释放已取得的部分
+        void release() noexcept
+        {
+            if (m_sqes != nullptr)
+                ::munmap(m_sqes, m_sqes_size);
+            if (m_cq_ring != nullptr && m_cq_ring != m_sq_ring)
+                ::munmap(m_cq_ring, m_cq_size);
+            if (m_sq_ring != nullptr)
+                ::munmap(m_sq_ring, m_sq_size);
+            ::close(m_ring);
+        }
+
+        /// \param opcodes 操作码
+        /// \return 内核是否支持全部操作码；不支持IORING_REGISTER_PROBE的内核视为不支持
+        bool supports(std::initializer_list<int> opcodes) const
+        {
+            constexpr unsigned kProbeOps = 256;
+            std::vector<char> buffer(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+            auto probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+            if (::syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_PROBE, probe, kProbeOps) < 0)
+                return false;
+            return std::all_of(opcodes.begin(), opcodes.end(), [probe](int op) {
+                return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+            });
+        }
+
+        void* map(size_t size, off_t offset)
+        {
+            void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, offset);
+            if (addr == MAP_FAILED)
+                throw std::logic_error(std::string("Cannot Map io_uring (") + std::strerror(errno) + ")");
+            return addr;
+        }
+
+        /// \throws std::logic_error
+        /// \param lock 已持有的m_lock
+        /// \brief 提交队列已满时先提交其中的项。其他提交者可能在enter()等待期间填满了队列
+        void make_room(std::unique_lock<std::mutex>& lock)
+        {
+            while (m_unsubmitted == m_sq_entries)
+                enter(lock);
+        }
+
+        /// \brief 填写一个提交队列项，调用者须持有m_lock且已通过make_room()确保队列未满
+        void push(int opcode, io_piece* piece)
+        {
+            assert(m_unsubmitted < m_sq_entries);
+            const unsigned tail = *m_sq_tail;
+            const unsigned index = tail & m_sq_mask;
+            io_uring_sqe& sqe = m_sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = opcode;
+            sqe.fd = m_fd;
+            if (piece != nullptr) {
+                sqe.off = piece->request.offset;
+                sqe.addr = reinterpret_cast<uint64_t>(piece->request.buffer);
+                sqe.len = piece->request.length;
+            }
+            sqe.user_data = reinterpret_cast<uint64_t>(piece);
+            m_sq_array[index] = index;
+            __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+            ++m_unsubmitted;
+        }
+
+        /// \throws std::logic_error
+        /// \param lock 已持有的m_lock
+        /// \brief 提交队列中的全部项，包括其他提交者填写的。内核因完成队列积压而拒绝时，先等收割线程取走一些完成项再重试，
+        /// 等待期间其他提交者可以继续填写队列
+        void enter(std::unique_lock<std::mutex>& lock)
+        {
+            while (m_unsubmitted > 0) {
+                const int n = static_cast<int>(::syscall(__NR_io_uring_enter, m_ring, m_unsubmitted, 0, 0, nullptr, 0));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0 && (errno == EAGAIN || errno == EBUSY)) {
+                    const unsigned in_flight = m_in_flight;
+                    if (in_flight <= m_unsubmitted) // Nothing Of Ours In The Kernel To Reap, So It Cannot Last.
+                        std::this_thread::yield();
+                    else
+                        m_drained.wait(lock, [this, in_flight] { return m_in_flight < in_flight; });
+                    continue;
+                }
+                if (n < 0)
+                    throw std::logic_error(std::string("Cannot Submit To io_uring (") + std::strerror(errno) + ")");
+                m_unsubmitted -= std::min<unsigned>(n, m_unsubmitted);
+            }
+        }
+
+        void reap()
+        {
+            for (;;) {
+                {
+                    std::lock_guard lock(m_lock);
+                    if (m_stopping && m_in_flight == 0)
+                        return;
+                }
+                ::syscall(__NR_io_uring_enter, m_ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+                unsigned head = *m_cq_head;
+                const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                std::vector<io_uring_cqe> completions;
+                for (; head != tail; ++head)
+                    if (m_cqes[head & m_cq_mask].user_data != 0)
+                        completions.push_back(m_cqes[head & m_cq_mask]);
+                __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+                if (completions.empty())
+                    continue;
+
+                {
+                    // Also Orders Us After The Submitter, Which Only Released The Lock Once Its Pieces Were Queued.
+                    std::lock_guard lock(m_lock);
+                    m_in_flight -= completions.size();
+                }
+                m_drained.notify_all();
+
+                for (const auto& cqe : completions) {
+                    auto piece = reinterpret_cast<io_piece*>(cqe.user_data);
+                    // Short, Interrupted Or Rejected Transfers Are Finished Synchronously, Where pread/pwrite Report Real Errors.
+                    if (cqe.res < 0 && cqe.res != -EINTR && cqe.res != -EAGAIN && cqe.res != -EINVAL && cqe.res != -EOPNOTSUPP) {
+                        piece->batch->finish(std::make_exception_ptr(std::logic_error(
+                            std::string(piece->request.write ? "Cannot Write To Image File" : "Cannot Read From Image File") + " (" + std::strerror(-cqe.res) + ")")));
+                        delete piece;
+                        continue;
+                    }
+                    const size_t done = std::max(cqe.res, 0);
+                    piece->request.offset += done;
+                    piece->request.buffer = static_cast<char*>(piece->request.buffer) + done;
+                    piece->request.length -= done;
+                    complete(piece, m_fd);
+                }
+            }
+        }
+
+        int m_ring = -1;
+        void* m_sq_ring = nullptr;
+        void* m_cq_ring = nullptr;
+        size_t m_sq_size = 0, m_cq_size = 0, m_sqes_size = 0;
+        io_uring_sqe* m_sqes = nullptr;
+        unsigned *m_sq_head = nullptr, *m_sq_tail = nullptr, *m_sq_array = nullptr;
+        unsigned m_sq_mask = 0, m_sq_entries = 0;
+        unsigned *m_cq_head = nullptr, *m_cq_tail = nullptr;
+        io_uring_cqe* m_cqes = nullptr;
+        unsigned m_cq_mask = 0, m_cq_entries = 0;
+
+        std::mutex m_lock; ///< 保护提交队列、m_unsubmitted与m_in_flight
+        std::condition_variable m_drained; ///< 有请求完成时通知等待空位的提交者
+        unsigned m_unsubmitted = 0; ///< 已填入提交队列、尚未被内核取走的项数
+        unsigned m_in_flight = 0;
+        bool m_stopping = false;
+        std::thread m_reaper;
+    };
+
+}
+
+io_engine::io_engine() = default;
+
+io_engine::io_engine(int fd, io_backend backend)
+{
+    if (backend == io_backend::uring) {
+        try {
+            m_impl = std::make_unique<uring_backend>(fd);
+        } catch (const std::logic_error&) { // Old Kernel Or Forbidden By seccomp.
+        }
+    }
+    if (!m_impl)
+        m_impl = std::make_unique<pool_backend>(fd);
+}
+
+io_engine::io_engine(io_engine&& other) noexcept = default;
+io_engine& io_engine::operator=(io_engine&& other) noexcept = default;
+io_engine::~io_engine() = default;
+
+io_backend io_engine::backend() const
+{
+    return m_impl->backend();
+}
+
+std::future<void> io_engine::submit(const std::vector<io_request>& requests)
+{
+    auto batch = std::make_shared<io_batch>();
+    auto ready = batch->done.get_future();
+
+    std::vector<io_piece*> pieces;
+    for (const auto& request : requests)
+        for (size_t done = 0; done < request.length; done += kMaxPieceSize) {
+            io_request piece = request;
+            piece.offset += done;
+            piece.buffer = static_cast<char*>(request.buffer) + done;
+            piece.length = std::min(kMaxPieceSize, request.length - done);
+            pieces.push_back(new io_piece { batch, piece });
+        }
+
+    if (pieces.empty()) {
+        batch->done.set_value();
+        return ready;
+    }
+    batch->remaining.store(pieces.size(), std::memory_order_relaxed);
+    m_impl->submit(pieces);
+    return ready;
+}
+
+void io_engine::run(const std::vector<io_request>& requests)
+{
+    submit(requests).get();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace jrfs {
+
+/// \brief I/O引擎的实现方式
+enum class io_backend {
+    uring, ///< Linux io_uring：一次系统调用提交一整批请求，由内核并发完成
+    thread_pool, ///< 工作线程池 + pread/pwrite，内核不支持io_uring时使用
+};
+
+/// \brief 对镜像的一次读或写
+struct io_request {
+    bool write = false; ///< 为真时将buffer写入镜像，否则从镜像读入buffer
+    size_t offset = 0; ///< 镜像中的偏移
+    void* buffer = nullptr; ///< 数据缓冲区，须保持有效直到请求完成
+    size_t length = 0; ///< 字节数
+};
+
+/// \brief 镜像文件的异步I/O引擎：批量提交读写请求，调用者可在等待期间继续计算。
+/// 优先使用io_uring，不可用时退化为线程池；大请求会被拆成多段并发完成。两种实现对调用者完全相同
+class io_engine {
+public:
+    static constexpr size_t kMaxPieceSize = 1 << 20; ///< 请求被拆分后每段的最大字节数
+
+    io_engine();
+
+    /// \param fd 文件描述符，须在引擎析构之后才关闭
+    /// \param backend 期望的实现方式，io_uring不可用时自动退化为线程池
+    explicit io_engine(int fd, io_backend backend = io_backend::uring);
+
+    io_engine(io_engine&& other) noexcept;
+    io_engine& operator=(io_engine&& other) noexcept;
+
+    /// \brief 等待所有已提交的请求完成后再析构
+    ~io_engine();
+
+    /// \return 实际使用的实现方式
+    io_backend backend() const;
+
+    /// \throws std::logic_error 无法提交时抛出
+    /// \param requests 一批请求
+    /// \return 全部请求完成后就绪的future；任一请求失败时其中保存std::logic_error
+    std::future<void> submit(const std::vector<io_request>& requests);
+
+    /// \throws std::logic_error
+    /// \param requests 一批请求
+    /// \brief 提交一批请求并等待全部完成
+    void run(const std::vector<io_request>& requests);
+
+    class impl;
+
+private:
+    std::unique_ptr<impl> m_impl;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "journal.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace jrfs {
+
+static_assert(sizeof(journal_record) == 32, "Journal Records Are Written As Raw Bytes!");
+
+/// \return FNV-1a校验和
+static uint32_t checksum(const char* bytes, size_t length)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+        h = (h ^ static_cast<unsigned char>(bytes[i])) * 16777619u;
+    return h;
+}
+
+void journal::transaction::add(size_t offset, const void* data, size_t length)
+{
+    std::memcpy(reserve(offset, length), data, length);
+}
+
+char* journal::transaction::reserve(size_t offset, size_t length)
+{
+    journal_record record;
+    record.offset = offset;
+    record.length = length;
+
+    const size_t pos = m_bytes.size();
+    m_bytes.resize(pos + sizeof(record) + length);
+    std::memcpy(m_bytes.data() + pos, &record, sizeof(record));
+    return m_bytes.data() + pos + sizeof(record);
+}
+
+bool journal::transaction::empty() const
+{
+    return m_bytes.empty();
+}
+
+size_t journal::transaction::size() const
+{
+    return m_bytes.size();
+}
+
+void journal::transaction::append(const transaction& other)
+{
+    m_bytes.insert(m_bytes.end(), other.m_bytes.begin(), other.m_bytes.end());
+}
+
+journal::journal(size_t offset, size_t size)
+    : m_offset(offset)
+    , m_size(size)
+{
+}
+
+bool journal::fits(const transaction& txn) const
+{
+    return fits(txn.size());
+}
+
+bool journal::fits(size_t bytes) const
+{
+    return m_head + bytes + sizeof(journal_record) <= m_size;
+}
+
+void journal::commit(image_file& image, transaction& txn)
+{
+    // Sequence Numbers Are Only Known Now, Stamp Them Into Every Record.
+    for (size_t pos = 0; pos < txn.m_bytes.size();) {
+        journal_record record;
+        std::memcpy(&record, txn.m_bytes.data() + pos, sizeof(record));
+        record.sequence = m_sequence;
+        std::memcpy(txn.m_bytes.data() + pos, &record, sizeof(record));
+        pos += sizeof(record) + record.length;
+    }
+
+    journal_record commit_record;
+    commit_record.sequence = m_sequence;
+    commit_record.offset = journal_record::kCommit;
+    commit_record.checksum = checksum(txn.m_bytes.data(), txn.m_bytes.size());
+    txn.m_bytes.insert(txn.m_bytes.end(), reinterpret_cast<const char*>(&commit_record), reinterpret_cast<const char*>(&commit_record + 1));
+
+    image.write(m_offset + m_head, txn.m_bytes.data(), txn.m_bytes.size());
+    image.flush();
+    m_head += txn.m_bytes.size();
+    ++m_sequence;
+}
+
+int journal::replay(image_file& image)
+{
+    journal_header header;
+    image.read(m_offset, &header, sizeof(header));
+    if (header.magic != journal_record::kMagic) { // Never Written, Nothing To Replay.
+        reset(image);
+        return 0;
+    }
+
+    std::vector<char> log(m_size - sizeof(journal_header));
+    image.read(m_offset + sizeof(journal_header), log.data(), log.size());
+
+    int replayed = 0;
+    size_t pos = 0;
+    m_sequence = header.sequence;
+    for (size_t begin = 0;; begin = pos) {
+        // Walk Up To The Commit Record. Anything Torn Or Stale Ends The Log.
+        journal_record record;
+        bool committed = false;
+        while (pos + sizeof(record) <= log.size()) {
+            std::memcpy(&record, log.data() + pos, sizeof(record));
+            if (record.magic != journal_record::kMagic || record.sequence != m_sequence)
+                break;
+            if (record.offset == journal_record::kCommit) {
+                committed = record.checksum == checksum(log.data() + begin, pos - begin);
+                break;
+            }
+            if (pos + sizeof(record) + record.length > log.size())
+                break;
+            pos += sizeof(record) + record.length;
+        }
+        if (!committed)
+            break;
+
+        apply(image, log.data() + begin, pos - begin);
+        pos += sizeof(record);
+        ++m_sequence;
+        ++replayed;
+    }
+
+    image.flush(); // Home Locations Must Be Durable Before The Log Forgets Them.
+    reset(image);
+    return replayed;
+}
+
+void journal::reset(image_file& image)
+{
+    journal_header header;
+    header.sequence = m_sequence;
+    image.write(m_offset, &header, sizeof(header));
+    image.flush();
+    m_head = sizeof(journal_header);
+}
+
+void journal::apply(image_file& image, const transaction& txn)
+{
+    apply(image, txn.m_bytes.data(), txn.m_bytes.size());
+}
+
+void journal::apply(image_file& image, const char* bytes, size_t length)
+{
+    for (size_t pos = 0; pos < length;) {
+        journal_record record;
+        std::memcpy(&record, bytes + pos, sizeof(record));
+        image.write(record.offset, bytes + pos + sizeof(record), record.length);
+        pos += sizeof(record) + record.length;
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "image_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jrfs {
+
+/// \brief 日志记录头，其后紧跟length字节的负载，重放时原样写回镜像的offset处。
+/// 每个事务以一条没有负载的提交记录结尾，其checksum覆盖同一事务中此前的全部字节
+struct journal_record {
+    static constexpr uint32_t kMagic = 0x4C4A524A; ///< "JRJL"
+    static constexpr uint64_t kCommit = ~uint64_t { 0 }; ///< offset为此值的是提交记录
+
+    uint32_t magic = kMagic;
+    uint32_t length = 0; ///< 负载的字节数
+    uint64_t sequence = 0; ///< 所属事务的序号
+    uint64_t offset = 0; ///< 负载在镜像中的偏移
+    uint32_t checksum = 0; ///< 仅提交记录使用
+    uint32_t reserved = 0;
+};
+
+/// \brief 日志区头部，记录日志中第一个事务应有的序号；序号更小的事务都已失效
+struct journal_header {
+    uint32_t magic = journal_record::kMagic;
+    uint32_t reserved = 0;
+    uint64_t sequence = 0;
+};
+
+/// \brief 位于镜像末尾的重做日志（redo log）。
+/// 修改先以事务的形式追加到日志并落盘，之后才写回原处；挂载时按序重放序号连续且校验和正确的事务，
+/// 遇到第一个不完整的事务即停止。日志不循环使用：写满时先检查点（重放到原处），再从头写起。
+class journal {
+public:
+    /// \brief 内存中正在组装的事务
+    class transaction {
+    public:
+        /// \param offset 镜像中的偏移
+        /// \param data 修改后的内容
+        /// \param length 字节数
+        /// \brief 记录一段修改
+        void add(size_t offset, const void* data, size_t length);
+
+        /// \param offset 镜像中的偏移
+        /// \param length 字节数
+        /// \return 新记录的负载，由调用者填写
+        /// \brief 记录一段修改，内容稍后填写，适合由多段不连续的内存拼成的修改
+        char* reserve(size_t offset, size_t length);
+
+        /// \return 是否没有任何修改
+        bool empty() const;
+
+        /// \return 全部记录（不含提交记录）的字节数
+        size_t size() const;
+
+        /// \param other 另一个事务
+        /// \brief 将other的全部记录追加到本事务末尾
+        void append(const transaction& other);
+
+    private:
+        friend class journal;
+
+        std::vector<char> m_bytes; ///< 依次排列的记录头与负载
+    };
+
+    journal() = default;
+
+    /// \param offset 日志区在镜像中的偏移
+    /// \param size 日志区的字节数
+    journal(size_t offset, size_t size);
+
+    /// \param txn 事务
+    /// \return 事务连同提交记录能否写入日志的剩余空间
+    bool fits(const transaction& txn) const;
+
+    /// \param bytes 事务全部记录（不含提交记录）的字节数
+    /// \return 这样大小的事务连同提交记录能否写入日志的剩余空间
+    bool fits(size_t bytes) const;
+
+    /// \throws std::logic_error
+    /// \param image 镜像文件
+    /// \param txn 事务，须满足fits(txn)
+    /// \brief 为事务分配序号，连同提交记录一次写入日志并落盘
+    void commit(image_file& image, transaction& txn);
+
+    /// \throws std::logic_error
+    /// \param image 镜像文件
+    /// \return 重放的事务个数
+    /// \brief 将日志中已提交的事务依次写回原处，落盘后清空日志
+    int replay(image_file& image);
+
+    /// \throws std::logic_error
+    /// \param image 镜像文件
+    /// \brief 清空日志：写入新的头部并落盘，此前的事务全部失效
+    void reset(image_file& image);
+
+    /// \throws std::logic_error
+    /// \param image 镜像文件
+    /// \param txn 事务
+    /// \brief 不经过日志，直接将事务写回原处（不保证原子性）
+    static void apply(image_file& image, const transaction& txn);
+
+private:
+    /// \param bytes 依次排列的记录头与负载
+    /// \param length 字节数
+    /// \brief 将每条记录的负载写回原处
+    static void apply(image_file& image, const char* bytes, size_t length);
+
+    size_t m_offset = 0; ///< 日志区在镜像中的偏移
+    size_t m_size = 0; ///< 日志区的字节数
+    size_t m_head = sizeof(journal_header); ///< 下一个事务在日志区中的写入位置
+    uint64_t m_sequence = 0; ///< 下一个事务的序号
+};
+
+}
\ No newline at end of file
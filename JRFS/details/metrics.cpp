@@ -0,0 +1,143 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace jrfs {
+
+int latency_histogram::bucket_of(uint64_t value)
+{
+    if (value < kSubBuckets)
+        return static_cast<int>(value);
+    const int exponent = 63 - __builtin_clzll(value); // At Least kSubBucketBits.
+    const int sub = static_cast<int>(value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return ((exponent - kSubBucketBits + 1) << kSubBucketBits) + sub;
+}
+
+uint64_t latency_histogram::upper_bound(int bucket)
+{
+    if (bucket < kSubBuckets)
+        return bucket;
+    const int shift = (bucket >> kSubBucketBits) - 1;
+    const uint64_t lower = static_cast<uint64_t>(kSubBuckets + (bucket & (kSubBuckets - 1))) << shift;
+    return lower + ((uint64_t { 1 } << shift) - 1);
+}
+
+void latency_histogram::record(uint64_t value)
+{
+    m_counts[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        ;
+}
+
+latency_histogram::snapshot latency_histogram::get() const
+{
+    snapshot ret;
+    for (int i = 0; i < kBuckets; ++i)
+        ret.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    ret.count = m_count.load(std::memory_order_relaxed);
+    ret.sum = m_sum.load(std::memory_order_relaxed);
+    ret.max = m_max.load(std::memory_order_relaxed);
+    return ret;
+}
+
+void latency_histogram::reset()
+{
+    for (auto& c : m_counts)
+        c.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+double latency_histogram::snapshot::mean() const
+{
+    return count == 0 ? 0 : static_cast<double>(sum) / count;
+}
+
+uint64_t latency_histogram::snapshot::percentile(double p) const
+{
+    // Buckets Are Read One By One While Others Record, So Rank Against Their Own Total.
+    uint64_t total = 0;
+    for (auto c : counts)
+        total += c;
+    if (total == 0)
+        return 0;
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100 * total + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(upper_bound(i), max);
+    }
+    return max;
+}
+
+metrics::metrics()
+{
+    if constexpr (kMetricsEnabled)
+        m_storage = std::make_unique<storage>();
+}
+
+metrics::~metrics() = default;
+
+metrics_snapshot metrics::snapshot() const
+{
+    metrics_snapshot ret;
+    if constexpr (kMetricsEnabled) {
+        for (int i = 0; i < kMetricOps; ++i)
+            ret.latency[i] = m_storage->latency[i].get();
+        ret.scan_length = m_storage->scan_length.get();
+        ret.bytes_read = m_storage->bytes_read.load(std::memory_order_relaxed);
+        ret.bytes_written = m_storage->bytes_written.load(std::memory_order_relaxed);
+        ret.blocks_allocated = m_storage->blocks_allocated.load(std::memory_order_relaxed);
+        ret.unjournaled_commits = m_storage->unjournaled_commits.load(std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+void metrics::reset()
+{
+    if constexpr (kMetricsEnabled) {
+        for (auto& h : m_storage->latency)
+            h.reset();
+        m_storage->scan_length.reset();
+        m_storage->bytes_read.store(0, std::memory_order_relaxed);
+        m_storage->bytes_written.store(0, std::memory_order_relaxed);
+        m_storage->blocks_allocated.store(0, std::memory_order_relaxed);
+        m_storage->unjournaled_commits.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string metrics_snapshot::report() const
+{
+    static constexpr const char* kNames[kMetricOps] = { "fopen", "path_to_inode", "read", "write", "allocate", "sync_image", "load_image" };
+
+    std::ostringstream out;
+    if (!kMetricsEnabled) {
+        out << "Metrics Are Disabled. Build With JRFS_METRICS To Enable Them.\n";
+        return out.str();
+    }
+
+    out << std::left << std::setw(16) << "operation" << std::right
+        << std::setw(10) << "count" << std::setw(12) << "mean(ns)" << std::setw(12) << "p50(ns)"
+        << std::setw(12) << "p90(ns)" << std::setw(12) << "p99(ns)" << std::setw(12) << "max(ns)" << '\n';
+    for (int i = 0; i < kMetricOps; ++i) {
+        const auto& h = latency[i];
+        out << std::left << std::setw(16) << kNames[i] << std::right
+            << std::setw(10) << h.count << std::setw(12) << static_cast<uint64_t>(h.mean()) << std::setw(12) << h.percentile(50)
+            << std::setw(12) << h.percentile(90) << std::setw(12) << h.percentile(99) << std::setw(12) << h.max << '\n';
+    }
+    out << "bytes read       " << bytes_read << '\n'
+        << "bytes written    " << bytes_written << '\n'
+        << "blocks allocated " << blocks_allocated << '\n'
+        << "unjournaled      " << unjournaled_commits << '\n'
+        << "scan length      mean " << scan_length.mean() << ", p99 " << scan_length.percentile(99) << ", max " << scan_length.max << '\n';
+    return out.str();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "config.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace jrfs {
+
+/// \brief 被统计耗时的操作
+enum class metric_op {
+    fopen,
+    path_to_inode, ///< 每一次路径查找，包括fopen、fcreate、fdelete等内部的查找，不含等待命名空间锁的时间
+    read, ///< filehander的readv、read_into与read
+    write, ///< filehander的write与pwrite，不含缓冲区之后再写入文件的部分
+    allocate, ///< 为文件分配数据块
+    sync_image,
+    load_image,
+};
+
+constexpr int kMetricOps = 7;
+
+/// \brief HDR风格的对数-线性直方图：每个2的幂区间再均分为2^kSubBucketBits个桶，
+/// 任意取值的相对误差不超过1/2^kSubBucketBits，而桶数与取值范围无关。记录是无锁的
+class latency_histogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    /// \brief 直方图在某一时刻的副本
+    struct snapshot {
+        std::array<uint64_t, kBuckets> counts {};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        /// \return 平均值，没有记录时为0
+        double mean() const;
+
+        /// \param p 百分位，取值[0, 100]
+        /// \return 不小于p%记录的最小桶的上界（不超过max），没有记录时为0
+        uint64_t percentile(double p) const;
+    };
+
+    /// \param value 记录的值
+    void record(uint64_t value);
+
+    snapshot get() const;
+
+    void reset();
+
+    /// \param value 取值
+    /// \return 所在桶的下标
+    static int bucket_of(uint64_t value);
+
+    /// \param bucket 桶下标
+    /// \return 桶中的最大取值
+    static uint64_t upper_bound(int bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> m_counts {};
+    std::atomic<uint64_t> m_count { 0 }, m_sum { 0 }, m_max { 0 };
+};
+
+/// \brief 全部统计数据在某一时刻的副本
+struct metrics_snapshot {
+    std::array<latency_histogram::snapshot, kMetricOps> latency; ///< 各操作的耗时（纳秒），次数即其count
+    latency_histogram::snapshot scan_length; ///< 每次分配数据块时检查过的空闲段个数
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+    uint64_t blocks_allocated = 0;
+    uint64_t unjournaled_commits = 0; ///< 比整个日志区还大、只能直接写回原处（不保证原子性）的提交次数
+
+    /// \param o 操作
+    /// \return 操作的耗时直方图
+    inline const latency_histogram::snapshot& operator[](metric_op o) const { return latency[static_cast<int>(o)]; }
+
+    /// \return 便于阅读的表格：每个操作的次数、平均与p50/p90/p99/最大耗时，以及字节数与扫描长度
+    std::string report() const;
+};
+
+/// \brief 文件系统的运行统计：各操作的次数与耗时直方图、读写字节数及分配器的扫描长度。
+/// 编译时未定义JRFS_METRICS则kMetricsEnabled为假，此时不分配存储，记录与计时都被编译为空操作
+class metrics {
+public:
+    /// \brief 在作用域内计时，析构时记入对应操作的直方图
+    class scoped_timer {
+    public:
+        inline scoped_timer(metrics& m, metric_op o)
+            : m_metrics(m)
+            , m_op(o)
+        {
+            if constexpr (kMetricsEnabled)
+                m_begin = std::chrono::steady_clock::now();
+        }
+
+        inline ~scoped_timer()
+        {
+            if constexpr (kMetricsEnabled)
+                m_metrics.record(m_op, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_begin).count());
+        }
+
+        scoped_timer(const scoped_timer&) = delete;
+        scoped_timer& operator=(const scoped_timer&) = delete;
+
+    private:
+        metrics& m_metrics;
+        const metric_op m_op;
+        std::chrono::steady_clock::time_point m_begin;
+    };
+
+    metrics();
+    ~metrics();
+
+    /// \param o 操作
+    /// \param ns 耗时（纳秒）
+    inline void record(metric_op o, uint64_t ns)
+    {
+        if constexpr (kMetricsEnabled)
+            m_storage->latency[static_cast<int>(o)].record(ns);
+    }
+
+    /// \param bytes 读出的字节数
+    inline void add_read(uint64_t bytes)
+    {
+        if constexpr (kMetricsEnabled)
+            m_storage->bytes_read.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /// \param bytes 写入的字节数
+    inline void add_written(uint64_t bytes)
+    {
+        if constexpr (kMetricsEnabled)
+            m_storage->bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /// \param blocks 本次分配的数据块个数
+    /// \param probes 本次分配检查过的空闲段个数
+    inline void add_allocation(uint64_t blocks, uint64_t probes)
+    {
+        if constexpr (kMetricsEnabled) {
+            m_storage->blocks_allocated.fetch_add(blocks, std::memory_order_relaxed);
+            m_storage->scan_length.record(probes);
+        }
+    }
+
+    /// \brief 记录一次绕过日志、直接写回原处的提交
+    inline void add_unjournaled()
+    {
+        if constexpr (kMetricsEnabled)
+            m_storage->unjournaled_commits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// \return 当前统计数据的副本；未启用时全为0
+    metrics_snapshot snapshot() const;
+
+    /// \brief 清零全部统计数据
+    void reset();
+
+private:
+    struct storage {
+        std::array<latency_histogram, kMetricOps> latency;
+        latency_histogram scan_length;
+        std::atomic<uint64_t> bytes_read { 0 }, bytes_written { 0 }, blocks_allocated { 0 }, unjournaled_commits { 0 };
+    };
+
+    std::unique_ptr<storage> m_storage; ///< 未启用时为nullptr
+};
+
+}
\ No newline at end of file
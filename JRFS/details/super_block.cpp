@@ -5,7 +5,7 @@
 
 namespace jrfs {
 
-void super_block::read(std::fstream& istream)
+void super_block::read(std::istream& istream)
 {
     int check_magic;
     llread(istream, check_magic);
@@ -13,15 +13,37 @@ void super_block::read(std::fstream& istream)
         throw std::logic_error(
             "Magic Number Not Match! Unrecognizable superblock! Expected : " + std::to_string(magic) + "(" + std::bitset<sizeof(int) * 8>(magic).to_string() + "), however got: " + std::to_string(check_magic) + "(" + std::bitset<sizeof(int) * 8>(check_magic).to_string() + ")");
 
+    uint32_t check_byte_order;
+    llread(istream, check_byte_order);
+    if (check_byte_order != byte_order)
+        throw std::logic_error("Byte Order Not Match! The Image Was Created On A Machine With Different Endianness.");
+
+    int check_inode_size, check_block_size;
+    llread(istream, check_inode_size);
+    llread(istream, check_block_size);
+    if (check_inode_size != inode_size || check_block_size != block_size)
+        throw std::logic_error("Layout Not Match! Expected Inode/Block Size: " + std::to_string(inode_size) + "/" + std::to_string(block_size) + ", however got: " + std::to_string(check_inode_size) + "/" + std::to_string(check_block_size));
+
     llread(istream, block_total);
     llread(istream, inode_total);
+    llread(istream, clean);
+    llread(istream, mapping);
+    if (mapping != block_mapping::extent && mapping != block_mapping::indirect)
+        throw std::logic_error("Unknown Block Mapping: " + std::to_string(static_cast<int>(mapping)));
+    llread(istream, journal_blocks); // Zero In Images Made Before The Journal Existed.
 }
 
-void super_block::write(std::fstream& ostream) const
+void super_block::write(std::ostream& ostream) const
 {
     llwrite(ostream, magic);
+    llwrite(ostream, byte_order);
+    llwrite(ostream, inode_size);
+    llwrite(ostream, block_size);
     llwrite(ostream, block_total);
     llwrite(ostream, inode_total);
+    llwrite(ostream, clean);
+    llwrite(ostream, mapping);
+    llwrite(ostream, journal_blocks);
 }
 
 }
\ No newline at end of file
@@ -1,25 +1,99 @@
 #pragma once
 
 #include "config.hpp"
-#include <fstream>
+#include "data_block.hpp"
+#include "inode.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
 
 namespace jrfs {
 
+/// \brief 文件数据块的映射方式（镜像格式版本），创建镜像时选定
+enum class block_mapping : int {
+    extent = 0, ///< inode内联extent + 溢出的extent树
+    indirect = 1, ///< 直接块 + 一级间接块 + 二级间接块
+};
+
 /// \brief 文件系统元数据
 struct super_block {
     static constexpr int magic = 0x233333; ///< 用来标识文件系统的编号，镜像若前4byte不一致则说明不属于本文件系统；
+    static constexpr uint32_t byte_order = 0x01020304; ///< 字节序标记，不一致则说明镜像由不同字节序的机器产生
+    static constexpr int inode_size = sizeof(inode); ///< inode的内存布局大小，与镜像不一致时不能整块读写
+    static constexpr int block_size = sizeof(data_block); ///< 数据块的内存布局大小，与镜像不一致时不能整块读写
     int block_total; ///< block总数
     int inode_total; ///< inode总数
+    int clean = false; ///< 镜像是否被正常卸载；为真时bitmap区可信，否则挂载时需要重新扫描
+    block_mapping mapping = block_mapping::extent; ///< 文件数据块的映射方式
+    int journal_blocks = 0; ///< 日志区所占的数据块个数，为0表示镜像不带日志区
+
+    /// \param bits 位图的位数
+    /// \return 位图在镜像中的字节大小（按64位字存储）
+    static inline size_t bitmap_bytes(int bits)
+    {
+        return (static_cast<size_t>(bits) + 63) / 64 * sizeof(uint64_t);
+    }
+
+    /// \return inode区在镜像中的偏移
+    inline size_t inode_offset() const
+    {
+        return kHeaderSize;
+    }
+
+    /// \return inode位图在镜像中的偏移（bitmap区紧跟inode区）
+    inline size_t inode_bitmap_offset() const
+    {
+        return inode_offset() + static_cast<size_t>(inode_total) * sizeof(inode);
+    }
+
+    /// \return 数据块位图在镜像中的偏移
+    inline size_t block_bitmap_offset() const
+    {
+        return inode_bitmap_offset() + bitmap_bytes(inode_total);
+    }
+
+    /// \return bitmap区的字节大小，按数据块大小对齐
+    inline size_t bitmap_region_size() const
+    {
+        const size_t bytes = bitmap_bytes(inode_total) + bitmap_bytes(block_total);
+        return (bytes + kBlockSize - 1) / kBlockSize * kBlockSize;
+    }
+
+    /// \return 数据块区在镜像中的偏移
+    inline size_t block_offset() const
+    {
+        return inode_bitmap_offset() + bitmap_region_size();
+    }
+
+    /// \return 日志区在镜像中的偏移（紧跟数据块区）
+    inline size_t journal_offset() const
+    {
+        return block_offset() + static_cast<size_t>(block_total) * sizeof(data_block);
+    }
+
+    /// \return 日志区的字节大小
+    inline size_t journal_size() const
+    {
+        return static_cast<size_t>(journal_blocks) * kBlockSize;
+    }
+
+    /// \return 整个镜像的字节大小
+    inline size_t image_size() const
+    {
+        return journal_offset() + journal_size();
+    }
 
-    /// 从镜像中读出super block
-    /// \param istream 镜像fstream
-    void read(std::fstream& istream);
+    /// 从镜像中读出super block，并检查镜像的字节序与inode/数据块布局是否与本机一致
+    /// \throws std::logic_error
+    /// \param istream 镜像输入流
+    void read(std::istream& istream);
 
     /// 将super block写入镜像
-    /// \param ostream 镜像fstream
-    void write(std::fstream& ostream) const;
+    /// \param ostream 镜像输出流
+    void write(std::ostream& ostream) const;
 };
 
-static_assert(sizeof(super_block) + 4 == kSuperBlockSize, "Invalid Super Block Size!");
+static_assert(sizeof(super_block) + 4 * sizeof(int) == kSuperBlockSize, "Invalid Super Block Size!");
 
 }
\ No newline at end of file
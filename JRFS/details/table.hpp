@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace jrfs {
+
+/// \brief 定长连续表：既可以自己持有内存（读入内存的镜像），也可以只是一段外部内存的视图（mmap映射的镜像）
+template <typename T>
+class table {
+public:
+    table() = default;
+
+    /// \brief 分配并持有n个默认初始化的元素
+    /// \param n 元素个数
+    explicit table(size_t n)
+        : m_owned(new T[n]())
+        , m_data(m_owned.get())
+        , m_size(n)
+    {
+    }
+
+    /// \brief 构造一段外部内存的视图，不持有内存
+    /// \param data 外部内存首地址
+    /// \param n 元素个数
+    table(T* data, size_t n)
+        : m_data(data)
+        , m_size(n)
+    {
+    }
+
+    table(table&& other) noexcept
+        : m_owned(std::move(other.m_owned))
+        , m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+    {
+    }
+
+    table& operator=(table&& other) noexcept
+    {
+        m_owned = std::move(other.m_owned);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        return *this;
+    }
+
+    table(const table&) = delete;
+    table& operator=(const table&) = delete;
+
+    /// \return 是否只是外部内存的视图
+    bool is_view() const { return m_data != nullptr && !m_owned; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+
+    T& operator[](size_t i) { return m_data[i]; }
+    const T& operator[](size_t i) const { return m_data[i]; }
+
+    /// \throws std::out_of_range
+    T& at(size_t i)
+    {
+        check_range(i);
+        return m_data[i];
+    }
+
+    /// \throws std::out_of_range
+    const T& at(size_t i) const
+    {
+        check_range(i);
+        return m_data[i];
+    }
+
+    T& front() { return m_data[0]; }
+    const T& front() const { return m_data[0]; }
+    T& back() { return m_data[m_size - 1]; }
+    const T& back() const { return m_data[m_size - 1]; }
+
+    T* begin() { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+
+private:
+    void check_range(size_t i) const
+    {
+        if (i >= m_size)
+            throw std::out_of_range("Table Index " + std::to_string(i) + " Out Of Range " + std::to_string(m_size));
+    }
+
+    std::unique_ptr<T[]> m_owned;
+    T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+}
\ No newline at end of file
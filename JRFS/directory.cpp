@@ -0,0 +1,207 @@
+#include "details/dir_bucket.hpp"
+#include "filesystem.hpp"
+#include <cstring>
+
+namespace jrfs {
+
+// Directory inodes map their buckets exactly like file inodes map their data (see block_map.cpp),
+// And Keep inode.size As The Number Of Entries. The Buckets Form A Linear Hash Table:
+// With n Buckets And `low` The Largest Power Of Two Not Above n, Buckets Below n - low Are Already Split.
+// Adding Bucket n Splits Bucket n - low, So The Table Grows One Bucket At A Time And Never Rehashes At Once.
+static constexpr int kMaxLoad = dir_bucket::kMaxEntries * 3 / 4; ///< Average Entries Per Bucket Before Splitting.
+
+static inline uint32_t low_of(int n)
+{
+    return uint32_t{ 1 } << (31 - __builtin_clz(n));
+}
+
+static inline int bucket_of(uint32_t h, int n)
+{
+    const uint32_t low = low_of(n);
+    const uint32_t b = h & (2 * low - 1);
+    return b < static_cast<uint32_t>(n) ? b : h & (low - 1);
+}
+
+int filesystem::dir_lookup(const inode& dir, std::string_view name) const
+{
+    const int n = block_count(dir);
+    if (n == 0)
+        return kNULL;
+
+    for (int blk = block_id(dir, bucket_of(dir_bucket::hash(name), n)); blk != kNULL;) {
+        const auto bucket = dir_bucket::load(block_list[blk]);
+        const int i = bucket.find(name);
+        if (i >= 0)
+            return bucket.entries[i].inode_id;
+        blk = bucket.next;
+    }
+    return kNULL;
+}
+
+void filesystem::dir_insert(int dir_id, std::string_view name, int inode_id)
+{
+    assert(inode_list[dir_id].is_dir());
+    if (dir_lookup(inode_list[dir_id], name) != kNULL)
+        throw std::logic_error("Directory / File [" + std::string(name) + "] Already Exists!");
+
+    const int n = block_count(inode_list[dir_id]);
+    if (n == 0 || inode_list[dir_id].size >= n * kMaxLoad)
+        grow_directory(dir_id);
+
+    dir_entry entry { inode_id, "" };
+    name.copy(entry.name, sizeof(entry.name) - 1);
+    const auto& dir = inode_list[dir_id];
+    insert_into_bucket(block_id(dir, bucket_of(dir_bucket::hash(name), block_count(dir))), entry);
+
+    inode_list[dir_id].size += 1;
+    mark_dirty_inode(dir_id);
+}
+
+std::string filesystem::inode_path(int index) const
+{
+    std::vector<std::string_view> names;
+    for (; index != 0; index = inode_list[index].current_dir()) // Only The Root Is Its Own Parent.
+        names.emplace_back(inode_list[index].name, strnlen(inode_list[index].name, sizeof(inode::name)));
+
+    std::string path;
+    for (auto it = names.rbegin(); it != names.rend(); ++it)
+        path.append("/").append(*it);
+    return path.empty() ? "/" : path;
+}
+
+void filesystem::dir_remove(int dir_id, std::string_view name)
+{
+    auto& dir = inode_list[dir_id];
+    assert(dir.is_dir());
+
+    const int n = block_count(dir);
+    std::vector<int> chain;
+    for (int blk = n == 0 ? kNULL : block_id(dir, bucket_of(dir_bucket::hash(name), n)); blk != kNULL; blk = dir_bucket::load(block_list[blk]).next)
+        chain.push_back(blk);
+
+    int target = kNULL, index = -1;
+    for (int blk : chain) {
+        index = dir_bucket::load(block_list[blk]).find(name);
+        if (index >= 0) {
+            target = blk;
+            break;
+        }
+    }
+    if (target == kNULL)
+        throw std::logic_error("Cannot Find Directory / File [" + std::string(name) + "] In Its Directory!");
+    dentries.erase(dir_id, name, inode_path(dir_id));
+
+    // Fill The Hole With The Last Entry Of The Chain, Dropping The Last Overflow Block Once Empty.
+    const int last = chain.back();
+    auto last_bucket = dir_bucket::load(block_list[last]);
+    const auto moved = last_bucket.entries[--last_bucket.count];
+    if (last == target) {
+        if (index < last_bucket.count)
+            last_bucket.entries[index] = moved;
+    } else {
+        auto target_bucket = dir_bucket::load(block_list[target]);
+        target_bucket.entries[index] = moved;
+        target_bucket.store(block_list[target]);
+        mark_dirty_block(target);
+    }
+
+    if (last_bucket.count == 0 && chain.size() > 1) {
+        const int prev = chain[chain.size() - 2];
+        auto prev_bucket = dir_bucket::load(block_list[prev]);
+        prev_bucket.next = kNULL;
+        prev_bucket.store(block_list[prev]);
+        mark_dirty_block(prev);
+        release_block(last);
+    } else {
+        last_bucket.store(block_list[last]);
+        mark_dirty_block(last);
+    }
+
+    dir.size -= 1;
+    mark_dirty_inode(dir_id);
+}
+
+void filesystem::visit_dir_entries(const inode& dir, const std::function<void(const dir_entry&)>& fn) const
+{
+    const int n = block_count(dir);
+    for (int k = 0; k < n; ++k) {
+        for (int blk = block_id(dir, k); blk != kNULL;) {
+            const auto bucket = dir_bucket::load(block_list[blk]);
+            for (int i = 0; i < bucket.count; ++i)
+                fn(bucket.entries[i]);
+            blk = bucket.next;
+        }
+    }
+}
+
+void filesystem::visit_dir_blocks(const inode& dir, const std::function<void(int)>& fn) const
+{
+    visit_blocks(dir, fn); // Bucket Heads & The Mapping Itself.
+
+    const int n = block_count(dir);
+    for (int k = 0; k < n; ++k) // Overflow Blocks.
+        for (int blk = dir_bucket::load(block_list[block_id(dir, k)]).next; blk != kNULL; blk = dir_bucket::load(block_list[blk]).next)
+            fn(blk);
+}
+
+void filesystem::grow_directory(int dir_id)
+{
+    const int n = block_count(inode_list[dir_id]);
+    reserve_blocks(dir_id, n + 1);
+
+    const int new_head = block_id(inode_list[dir_id], n);
+    dir_bucket {}.store(block_list[new_head]);
+    mark_dirty_block(new_head);
+    if (n == 0)
+        return;
+
+    // Split The Sibling Bucket, Whose Entries Now Hash To Either It Or The New One.
+    // Its Overflow Blocks Are Reused, And Together With The New Head They Always Suffice, So Splitting Never Allocates.
+    const int sibling = n - low_of(n);
+    const int head = block_id(inode_list[dir_id], sibling);
+    std::vector<dir_entry> entries;
+    std::vector<int> spare;
+    for (int blk = head; blk != kNULL;) {
+        const auto bucket = dir_bucket::load(block_list[blk]);
+        entries.insert(entries.end(), bucket.entries, bucket.entries + bucket.count);
+        if (blk != head)
+            spare.push_back(blk);
+        blk = bucket.next;
+    }
+
+    dir_bucket {}.store(block_list[head]);
+    mark_dirty_block(head);
+    for (const auto& entry : entries) {
+        const int k = bucket_of(dir_bucket::hash(entry.view()), n + 1);
+        insert_into_bucket(k == sibling ? head : new_head, entry, &spare);
+    }
+    for (int blk : spare)
+        release_block(blk);
+}
+
+void filesystem::insert_into_bucket(int head, const dir_entry& entry, std::vector<int>* spare)
+{
+    int blk = head;
+    auto bucket = dir_bucket::load(block_list[blk]);
+    while (bucket.count == dir_bucket::kMaxEntries) {
+        if (bucket.next == kNULL) { // Chain A New Overflow Block.
+            if (spare != nullptr && !spare->empty()) {
+                bucket.next = spare->back();
+                spare->pop_back();
+                dir_bucket {}.store(block_list[bucket.next]);
+            } else {
+                bucket.next = allocate_map_block();
+            }
+            bucket.store(block_list[blk]);
+            mark_dirty_block(blk);
+        }
+        blk = bucket.next;
+        bucket = dir_bucket::load(block_list[blk]);
+    }
+
+    bucket.entries[bucket.count++] = entry;
+    bucket.store(block_list[blk]);
+    mark_dirty_block(blk);
+}
+
+}
\ No newline at end of file
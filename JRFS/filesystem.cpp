@@ -2,13 +2,28 @@
 #include "details/inode.hpp"
 #include "util/utility.hpp"
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 namespace jrfs {
 
+/// \return 路径的父文件夹路径与最后一级名字，如"/a/b"拆为"/a"与"b"
+static std::pair<std::string_view, std::string_view> split_parent(std::string_view path)
+{
+    if (path.size() > 1 && path.back() == '/')
+        path.remove_suffix(1);
+
+    const auto pos = path.rfind('/');
+    if (pos == std::string_view::npos) // Not A Global Path. Resolving "" Reports It.
+        return { "", path };
+    return { pos == 0 ? path.substr(0, 1) : path.substr(0, pos), path.substr(pos + 1) };
+}
+
 void filesystem::load_image()
 {
+    metrics::scoped_timer timer(op_metrics, metric_op::load_image);
     std::fstream is(mount_point, std::ios::in | std::ios::binary);
     if (!is.is_open())
         throw std::logic_error("Cannot Open Image File: " + std::string(mount_point));
@@ -16,71 +31,140 @@ void filesystem::load_image()
     is.seekp(0);
     meta_data.read(is);
 
-    // TODO: CHECK FILE SIZE.
-
-    inode_list.reserve(meta_data.inode_total);
-    inode_bitmap.resize(meta_data.inode_total, false);
-    for (int i = 0; i < meta_data.inode_total; ++i) {
-        inode inode;
-        inode.read(is);
-        inode_list.push_back(inode);
+    image = image_file(mount_point, false);
+    io = io_engine(image.fd());
+    if (image.size() < meta_data.image_size())
+        throw std::logic_error("Image File Is Truncated! Expected " + std::to_string(meta_data.image_size()) + " Bytes, However Got " + std::to_string(image.size()));
+
+    // Redo What Was Committed But Not Yet Written Back, Before Anything Is Read.
+    wal = journal(meta_data.journal_offset(), meta_data.journal_size());
+    if (meta_data.journal_blocks > 0) {
+        const int replayed = wal.replay(image);
+        if (replayed > 0)
+            std::cerr << "Replayed " << replayed << " Transactions From The Journal : " << mount_point << std::endl;
     }
 
-    block_list.reserve(meta_data.block_total);
-    block_bitmap.resize(meta_data.block_total, false);
-    for (int j = 0; j < meta_data.block_total; ++j) {
-        data_block block;
-        block.read(is);
-        block_list.push_back(block);
+    inode_bitmap = bitmap(meta_data.inode_total);
+    block_bitmap = bitmap(meta_data.block_total);
+    dirty_inodes.resize(meta_data.inode_total);
+    dirty_blocks.resize(meta_data.block_total);
+    pending_inodes.resize(meta_data.inode_total);
+    pending_blocks.resize(meta_data.block_total);
+    fresh_blocks.resize(meta_data.block_total);
+    released_blocks.resize(meta_data.block_total);
+    inode_locks = std::make_unique<std::shared_mutex[]>(meta_data.inode_total);
+    inode_generations = std::make_unique<uint32_t[]>(meta_data.inode_total);
+
+    if (meta_data.clean) // Bitmaps On Disk Are Trustworthy Only After A Clean Unmount.
+        load_bitmap();
+
+    if (mode == storage_mode::mmap) { // Just View The Mapped Image. Pages Are Loaded On Demand.
+        char* base = image.map();
+        inode_list = table<inode>(reinterpret_cast<inode*>(base + meta_data.inode_offset()), meta_data.inode_total);
+        block_list = block_cache(reinterpret_cast<data_block*>(base + meta_data.block_offset()), meta_data.block_total);
+        return;
     }
+
+    // Inodes Stay Resident: A Trivially Copyable Array With The Same Layout As The Image, Read In One Go.
+    // Data Blocks Are Read On First Access.
+    inode_list = table<inode>(meta_data.inode_total);
+    io.run({ { false, meta_data.inode_offset(), inode_list.data(), inode_list.size() * sizeof(inode) } });
+    block_list = block_cache(&image, meta_data.block_offset(), meta_data.block_total, cache_blocks);
+}
+
+void filesystem::load_bitmap()
+{
+    io.run({
+        { false, meta_data.inode_bitmap_offset(), inode_bitmap.words(), inode_bitmap.word_count() * sizeof(uint64_t) },
+        { false, meta_data.block_bitmap_offset(), block_bitmap.words(), block_bitmap.word_count() * sizeof(uint64_t) },
+    });
+
+    inode_bitmap.rebuild_summary();
+    inode_bitmap.clear_dirty();
+    block_bitmap.rebuild_summary();
+    block_bitmap.clear_dirty();
 }
 
 filesystem::~filesystem()
 {
+    {
+        std::lock_guard lock(async_lock);
+        stop_committer = true;
+    }
+    async_ready.notify_one();
+    if (committer.joinable()) // Pending Asynchronous Commits Are Served Before It Quits.
+        committer.join();
+
     sync_image();
+
+    meta_data.clean = true;
+    write_header();
+    image.flush();
 }
 
-filesystem::filehander filesystem::fopen(std::string_view path_)
+filesystem::filehander filesystem::fopen(std::string_view path)
 {
-    std::string path(path_);
-    auto tokens = utility::split(path, '/');
-    auto inode_index = path_to_inode(tokens, path);
+    metrics::scoped_timer timer(op_metrics, metric_op::fopen);
+    std::shared_lock lock(namespace_lock);
+    auto inode_index = find_inode(path);
     return filehander(*this, inode_index);
 }
 
-int filesystem::path_to_inode(const std::string& path)
+int filesystem::path_to_inode(std::string_view path)
 {
-    auto tokens = utility::split(path, '/');
-    return path_to_inode(tokens, path);
+    std::shared_lock lock(namespace_lock);
+    return find_inode(path);
 }
 
-void filesystem::fcreate(std::string_view path_)
+metrics_snapshot filesystem::stats() const
 {
-    std::string path(path_);
-    auto tokens = utility::split(path, '/');
+    return op_metrics.snapshot();
+}
 
-    auto new_file_name = std::move(tokens.back());
-    tokens.pop_back();
+void filesystem::reset_stats()
+{
+    op_metrics.reset();
+}
 
+int filesystem::find_inode(std::string_view path)
+{
+    metrics::scoped_timer timer(op_metrics, metric_op::path_to_inode);
+    const int cached = dentries.lookup_path(path);
+    if (cached >= 0)
+        return cached;
+
+    const int inode_index = resolve_path(utility::split_view(path, '/'), path);
+    dentries.insert_path(path, inode_index);
+    return inode_index;
+}
+
+void filesystem::fcreate(std::string_view path)
+{
+    std::unique_lock lock(namespace_lock);
+    const auto [dir_path, new_file_name] = split_parent(path);
+
+    if (new_file_name.empty())
+        throw std::logic_error("The Filename Must Not Be Empty!");
     if (new_file_name.length() >= sizeof(inode{}.name))
         throw std::logic_error("The Filename Length Must Be Less Than " + std::to_string(sizeof(inode{}.name) - 1));
 
-    int dir = path_to_inode(tokens, path);
+    int dir = find_inode(dir_path);
 
     assert(inode_list[dir].valid);
-    assert(inode_list[dir].is_dir());
+    if (!inode_list[dir].is_dir())
+        throw std::logic_error("Path Error: [" + std::string(inode_list[dir].name) + "] Is Not A Directory.");
     assert(inode_bitmap[dir]);
 
-    auto& directory_inode = inode_list[dir];
-
-    int next_slot = 2;
-    for (; next_slot < directory_inode.direct_block.size() && directory_inode.direct_block[next_slot] != kNULL; ++next_slot)
-        ;
-
-    if (next_slot == directory_inode.direct_block.size())
-        throw std::logic_error("A Directory Can Only Contain " + std::to_string(directory_inode.direct_block.size()) + " At Most.");
-
-    directory_inode.direct_block[next_slot] = create_file_inode(std::move(new_file_name), dir);
+    int new_inode = create_file_inode(new_file_name, dir);
+    try {
+        dir_insert(dir, new_file_name, new_inode);
+    } catch (const std::logic_error&) { // Give The Inode Back.
+        inode_list[new_inode].valid = false;
+        inode_bitmap.reset(new_inode);
+        throw;
+    }
+    lock.unlock();
+    auto_commit();
 }
 
 void filesystem::delete_directory_inode(int index)
@@ -91,84 +175,78 @@ void filesystem::delete_directory_inode(int index)
     assert(inode.is_dir());
     assert(inode.unix_time != 0);
 
-    if (inode.direct_block[1] == -1)
+    if (index == 0)
         throw std::logic_error("Cannot Remove Root Directory!");
 
-    inode.valid = false; // Invalid the flag.
-
-    // Remove The Bitmap.
-    inode_bitmap[index] = false;
-
-    // Remove From Father Directory.
-    auto father_index = inode.direct_block[1];
-    auto& father_inode = inode_list[father_index];
-    for (int i = 2; i < father_inode.direct_block.size(); ++i) {
-        if (father_inode.direct_block[i] == index) {
-            int j = i + 1;
-            for (; j < father_inode.direct_block.size(); ++j)
-                if (father_inode.direct_block[j] != kNULL)
-                    std::swap(father_inode.direct_block[j], father_inode.direct_block[j - 1]);
-                else
-                    break;
-            father_inode.direct_block[j - 1] = kNULL;
-            return;
-        }
-    }
-
-    for (int i = 2; i < inode.direct_block.size(); ++i) {
-        int sub_index = inode.direct_block[i];
-        if (kNULL == sub_index)
-            break;
-        auto& sub_node = inode_list[sub_index];
-        if (sub_node.is_dir())
+    // Remove Children First. Collect Them Before, As Each Removal Modifies This Directory.
+    std::vector<int> children;
+    children.reserve(inode.size);
+    visit_dir_entries(inode, [&children](const dir_entry& entry) { children.push_back(entry.inode_id); });
+    for (int sub_index : children) {
+        if (inode_list[sub_index].is_dir())
             delete_directory_inode(sub_index);
         else
             delete_file_inode(sub_index);
     }
+
+    // Release The Buckets.
+    visit_dir_blocks(inode, [this](int block_index) { release_block(block_index); });
+
+    // Remove From Father Directory.
+    dir_remove(inode.last_level_dir(), inode.name);
+
+    inode.valid = false; // Invalid the flag.
+    ++inode_generations[index]; // Open Handles Must Not Write Here Anymore.
+    inode_bitmap.reset(index);
+    mark_dirty_inode(index);
 }
 
-void filesystem::fdelete(std::string_view path_)
+void filesystem::fdelete(std::string_view path)
 {
-    std::string path(path_);
-    auto tokens = utility::split(path, '/');
-    auto inode_index = path_to_inode(tokens, path);
+    std::unique_lock lock(namespace_lock);
+    auto inode_index = find_inode(path);
     delete_file_inode(inode_index);
+    lock.unlock();
+    auto_commit();
 }
 
-void filesystem::rmdir(std::string_view path_)
+void filesystem::rmdir(std::string_view path)
 {
-    std::string path(path_);
-    auto tokens = utility::split(path, '/');
-    auto inode_index = path_to_inode(tokens, path);
+    std::unique_lock lock(namespace_lock);
+    auto inode_index = find_inode(path);
     delete_directory_inode(inode_index);
+    lock.unlock();
+    auto_commit();
 }
 
-void filesystem::mkdir(std::string_view path_)
+void filesystem::mkdir(std::string_view path)
 {
-    std::string path(path_);
-    auto tokens = utility::split(path, '/');
-    auto new_dir_name = std::move(tokens.back());
+    std::unique_lock lock(namespace_lock);
+    const auto [dir_path, new_dir_name] = split_parent(path);
 
+    if (new_dir_name.empty())
+        throw std::logic_error("The Directory Name Must Not Be Empty!");
     if (new_dir_name.length() >= sizeof(inode{}.name))
         throw std::logic_error("The Directory Name Length Must Be Less Than " + std::to_string(sizeof(inode{}.name) - 1));
-    tokens.pop_back();
 
-    int father_dir = path_to_inode(tokens, path);
-    auto& directory_inode = inode_list[father_dir];
+    int father_dir = find_inode(dir_path);
 
     assert(inode_list[father_dir].valid);
-    assert(inode_list[father_dir].is_dir());
+    if (!inode_list[father_dir].is_dir())
+        throw std::logic_error("Path Error: [" + std::string(inode_list[father_dir].name) + "] Is Not A Directory.");
     assert(inode_bitmap[father_dir]);
 
     // OK, we got the root path now. Let's create a new one.
-    int next_slot = 2;
-    for (; next_slot < directory_inode.direct_block.size() && directory_inode.direct_block[next_slot] != kNULL; ++next_slot)
-        ;
-
-    if (next_slot == directory_inode.direct_block.size())
-        throw std::logic_error("A Directory Can Only Contain " + std::to_string(directory_inode.direct_block.size()) + " At Most.");
-
-    directory_inode.direct_block[next_slot] = create_dir_inode(std::move(new_dir_name), father_dir);
+    int new_inode = create_dir_inode(new_dir_name, father_dir);
+    try {
+        dir_insert(father_dir, new_dir_name, new_inode);
+    } catch (const std::logic_error&) { // Give The Inode Back.
+        inode_list[new_inode].valid = false;
+        inode_bitmap.reset(new_inode);
+        throw;
+    }
+    lock.unlock();
+    auto_commit();
 }
 
 void filesystem::delete_file_inode(int index)
@@ -180,52 +258,26 @@ void filesystem::delete_file_inode(int index)
     assert(inode.unix_time != 0);
 
     inode.valid = false; // Invalid the flag.
+    ++inode_generations[index]; // Open Handles Must Not Write Here Anymore.
+    inode_bitmap.reset(index);
+    mark_dirty_inode(index);
 
     // Clean Block Bitmap First.
-    int direct_block_index = 1;
-    while (direct_block_index < inode.direct_block.size() && inode.direct_block[direct_block_index] != kNULL) {
-        block_bitmap[inode.direct_block[direct_block_index++]] = false;
-    }
-
-    if (inode.direct_block.size() == direct_block_index) { // If the block extends the direct_block range.
-        // Linked List Mode.
-        auto& block = block_list[inode.direct_block.back()];
-        int block_index = block.next;
-
-        while (block_index != kNULL) {
-            block_bitmap[block_index] = false;
-            block_index = block_list[block_index].next;
-        }
-    }
+    visit_blocks(inode, [this](int block_index) { release_block(block_index); });
 
     // Block Data Cleaned. Now lets clean the inode data.
-    auto& father_inode = inode_list[inode.direct_block[0]];
-    for (int i = 2; i < father_inode.direct_block.size(); ++i) {
-        if (father_inode.direct_block[i] == index) {
-            int j = i + 1;
-            for (; j < father_inode.direct_block.size(); ++j)
-                if (father_inode.direct_block[j] != kNULL)
-                    std::swap(father_inode.direct_block[j], father_inode.direct_block[j - 1]);
-                else
-                    break;
-            father_inode.direct_block[j - 1] = kNULL;
-            return;
-        }
-    }
-
-    assert(false); // Cannot find current inode in his father directory.
+    dir_remove(inode.current_dir(), inode.name);
 }
 
-int filesystem::create_file_inode(const std::string& new_file_name, int dir_index)
+int filesystem::create_file_inode(std::string_view new_file_name, int dir_index)
 {
-    auto it = std::find(inode_bitmap.begin(), inode_bitmap.end(), false);
-    if (it == inode_bitmap.end())
+    int new_inode_index = inode_bitmap.allocate();
+    if (new_inode_index < 0)
         throw std::logic_error("There's Not Enough Inodes Now!");
 
-    int new_inode_index = std::distance(inode_bitmap.begin(), it);
-
-    inode_bitmap[new_inode_index] = true;
     auto& new_inode = inode_list[new_inode_index];
+    new_inode = inode{}; // The Inode May Be A Recycled One.
+    mark_dirty_inode(new_inode_index);
 
     new_inode.valid = true;
     new_inode.is_directory = false;
@@ -237,23 +289,21 @@ int filesystem::create_file_inode(const std::string& new_file_name, int dir_inde
     return new_inode_index;
 }
 
-int filesystem::create_dir_inode(const std::string& new_dir_name, int dir_index)
+int filesystem::create_dir_inode(std::string_view new_dir_name, int dir_index)
 {
-    auto it = std::find(inode_bitmap.begin(), inode_bitmap.end(), false);
-    if (it == inode_bitmap.end())
+    int new_inode_index = inode_bitmap.allocate();
+    if (new_inode_index < 0)
         throw std::logic_error("There's Not Enough Inodes Now!");
 
-    int new_inode_index = std::distance(inode_bitmap.begin(), it);
-
-    inode_bitmap[new_inode_index] = true;
     auto& new_inode = inode_list[new_inode_index];
+    new_inode = inode{}; // The Inode May Be A Recycled One.
+    mark_dirty_inode(new_inode_index);
 
     new_inode.valid = true;
     new_inode.is_directory = true;
     new_dir_name.copy(new_inode.name, new_dir_name.length());
     new_inode.unix_time = std::time(nullptr);
-    new_inode.direct_block[0] = new_inode_index;
-    new_inode.direct_block[1] = dir_index;
+    new_inode.direct_block[0] = dir_index;
     new_inode.size = 0;
 
     return new_inode_index;
@@ -261,79 +311,209 @@ int filesystem::create_dir_inode(const std::string& new_dir_name, int dir_index)
 
 int filesystem::path_to_inode(const std::vector<std::string>& tokens, const std::string& path)
 {
-    if (tokens.empty() || !tokens.front().empty())
+    metrics::scoped_timer timer(op_metrics, metric_op::path_to_inode);
+    std::shared_lock lock(namespace_lock);
+    return resolve_path(tokens, path);
+}
+
+template <typename Tokens>
+int filesystem::resolve_path(const Tokens& tokens, std::string_view path)
+{
+    auto it = tokens.begin();
+    if (it == tokens.end() || !std::string_view(*it).empty())
         throw std::logic_error("Path Error[We Only Support Global Path!]: Can Not Recognize Root Path.");
 
     int last_dir_index = 0;
-    for (size_t i = 1; i < tokens.size(); ++i) {
-        const auto& inode_ = inode_list.at(last_dir_index);
-        assert(inode_.valid && inode_.is_dir());
-        for (int j = 2; j < inode_.direct_block.size(); ++j) {
-            int next_index = inode_.direct_block[j]; // A SubDirectory / SubFile.
-            if (next_index != kNULL && inode_list[next_index].name == tokens[i]) {
-                last_dir_index = next_index;
-                break;
-            }
-            if (j == inode_.direct_block.size() - 1 || next_index == kNULL)
-                throw std::logic_error("Cannot Find Directory / File [" + tokens[i] + "] in [" + path + "]");
+    for (++it; it != tokens.end(); ++it) {
+        const std::string_view name = *it;
+        int next_index = dentries.lookup(last_dir_index, name);
+        if (next_index < 0) {
+            const auto& inode_ = inode_list.at(last_dir_index);
+            assert(inode_.valid);
+            next_index = inode_.is_dir() ? dir_lookup(inode_, name) : kNULL; // A SubDirectory / SubFile.
+            if (next_index == kNULL)
+                throw std::logic_error("Cannot Find Directory / File [" + std::string(name) + "] in [" + std::string(path) + "]");
+            dentries.insert(last_dir_index, name, next_index);
         }
+        last_dir_index = next_index;
     }
     return last_dir_index;
 }
 
-void filesystem::sync_image()
+template int filesystem::resolve_path(const std::vector<std::string>&, std::string_view);
+template int filesystem::resolve_path(const utility::split_view&, std::string_view);
+
+void filesystem::mark_dirty_inode(int index)
 {
-    std::fstream os(mount_point, std::ios::trunc | std::ios::out | std::ios::binary);
-    if (!os.is_open())
-        throw std::logic_error("Cannot Write To Image File: " + std::string(mount_point));
+    std::lock_guard lock(dirty_lock);
+    dirty_inodes.mark(index);
+    if (journaled())
+        pending_inodes.mark(index);
+}
 
-    os.seekp(0);
+void filesystem::mark_dirty_block(int index)
+{
+    std::lock_guard lock(dirty_lock);
+    dirty_blocks.mark(index);
+    if (journaled())
+        pending_blocks.mark(index);
+}
+
+void filesystem::mark_fresh_block(int index)
+{
+    std::lock_guard lock(dirty_lock);
+    if (journaled() && !released_blocks.contains(index))
+        fresh_blocks.mark(index);
+}
+
+void filesystem::release_block(int index)
+{
+    block_bitmap.reset(index);
+    std::lock_guard lock(dirty_lock);
+    if (journaled())
+        released_blocks.mark(index);
+}
+
+void filesystem::write_header()
+{
+    std::ostringstream os;
     meta_data.write(os);
+    const auto header = os.str();
+    image.write(0, header.data(), header.size());
+}
 
-    for (auto&& inode : inode_list)
-        inode.write(os);
+void filesystem::sync_image()
+{
+    metrics::scoped_timer timer(op_metrics, metric_op::sync_image);
+    std::lock_guard commit(commit_lock);
+    std::unique_lock lock(namespace_lock); // Writers Hold It Shared, So No Block Changes Underneath.
+
+    // Log Everything First, So A Crash While Writing Back Can Be Redone.
+    if (journaled()) {
+        journal::transaction fresh;
+        auto txn = collect_transaction(fresh);
+        if (!txn.empty() || !fresh.empty())
+            write_transaction(txn, fresh);
+    }
 
-    for (auto&& blk : block_list)
-        blk.write(os);
+    // Only Inodes & Blocks Modified Since Last Sync Are Written Back, Each Run Of Adjacent Ones As One Request,
+    // And All Requests As One Batch.
+    std::vector<io_request> requests;
+    dirty_inodes.for_each_run([&](int begin, int count) {
+        const size_t offset = meta_data.inode_offset() + static_cast<size_t>(begin) * sizeof(inode);
+        if (mode == storage_mode::mmap)
+            image.sync(offset, count * sizeof(inode));
+        else
+            requests.push_back({ true, offset, &inode_list[begin], count * sizeof(inode) });
+    });
+    dirty_inodes.clear();
+
+    dirty_blocks.for_each_run([&](int begin, int count) {
+        const size_t offset = meta_data.block_offset() + static_cast<size_t>(begin) * sizeof(data_block);
+        if (mode == storage_mode::mmap) {
+            image.sync(offset, count * sizeof(data_block));
+            return;
+        }
+        for (int id = begin; id < begin + count; ++id) // Evicted Ones Were Written Back Already.
+            if (block_list.resident(id))
+                requests.push_back({ true, offset + static_cast<size_t>(id - begin) * sizeof(data_block), &block_list[id], sizeof(data_block) });
+    });
+    dirty_blocks.clear();
+
+    // Bitmaps Are Always In Memory, Write Back Their Modified Words.
+    auto sync_bitmap = [&](bitmap& bm, size_t bitmap_offset) {
+        bm.dirty_words().for_each_run([&](int begin, int count) {
+            requests.push_back({ true, bitmap_offset + begin * sizeof(uint64_t), bm.words() + begin, count * sizeof(uint64_t) });
+        });
+        bm.clear_dirty();
+    };
+    sync_bitmap(inode_bitmap, meta_data.inode_bitmap_offset());
+    sync_bitmap(block_bitmap, meta_data.block_bitmap_offset());
+    io.run(requests);
+
+    if (journaled()) { // Home Locations Now Hold Everything The Journal Did.
+        image.flush();
+        wal.reset(image);
+    }
+    evict_blocks();
 }
 
-void filesystem::create_image(int count_blocks)
+void filesystem::create_image(int count_blocks, block_mapping mapping)
 {
+    meta_data.mapping = mapping;
     meta_data.block_total = count_blocks;
     meta_data.inode_total = std::max(1, static_cast<int>(count_blocks * kInodePercent));
+    meta_data.journal_blocks = std::max(kMinJournalBlocks, static_cast<int>(count_blocks * kJournalPercent));
+
+    meta_data.clean = false; // Mounted Right Now.
+
+    // A Sparse, Zero Filled Image Is Exactly Empty Inodes & Blocks. So Only The Header, The Root And The Bitmaps Need Writing.
+    image = image_file(mount_point, true);
+    io = io_engine(image.fd());
+    image.resize(meta_data.image_size());
+    write_header();
+    wal = journal(meta_data.journal_offset(), meta_data.journal_size());
+    wal.reset(image);
+
+    if (mode == storage_mode::mmap) {
+        char* base = image.map();
+        inode_list = table<inode>(reinterpret_cast<inode*>(base + meta_data.inode_offset()), meta_data.inode_total);
+        block_list = block_cache(reinterpret_cast<data_block*>(base + meta_data.block_offset()), meta_data.block_total);
+    } else {
+        inode_list = table<inode>(meta_data.inode_total);
+        block_list = block_cache(&image, meta_data.block_offset(), meta_data.block_total, cache_blocks);
+    }
 
-    inode_list = std::vector<inode>(meta_data.inode_total);
-    block_list = std::vector<data_block>(meta_data.block_total);
+    dirty_inodes.resize(meta_data.inode_total);
+    dirty_blocks.resize(meta_data.block_total);
+    pending_inodes.resize(meta_data.inode_total);
+    pending_blocks.resize(meta_data.block_total);
+    fresh_blocks.resize(meta_data.block_total);
+    released_blocks.resize(meta_data.block_total);
+    inode_locks = std::make_unique<std::shared_mutex[]>(meta_data.inode_total);
+    inode_generations = std::make_unique<uint32_t[]>(meta_data.inode_total);
 
     inode_list.front().valid = true;
     inode_list.front().size = 0;
     inode_list.front().is_directory = true;
     inode_list.front().unix_time = std::time(nullptr);
-    inode_list.front().current_dir() = 0;
-    inode_list.front().last_level_dir() = -1;
-
-    this->sync_image();
+    inode_list.front().current_dir() = 0; // The Root Is Its Own Parent.
+    mark_dirty_inode(0);
 
     // MK ROOT DIR.
-    block_bitmap = decltype(block_bitmap)(meta_data.block_total, false);
-    block_bitmap[0] = true;
-    inode_bitmap = decltype(inode_bitmap)(meta_data.inode_total, false);
-    inode_bitmap[0] = true;
+    block_bitmap = bitmap(meta_data.block_total);
+    block_bitmap.set(0);
+    inode_bitmap = bitmap(meta_data.inode_total);
+    inode_bitmap.set(0);
+
+    this->sync_image();
 
     std::cout << "Successfully Created Filesystem : " << mount_point << std::endl;
 }
 
-filesystem::filesystem(const std::string& path)
+filesystem::filesystem(const std::string& path, storage_mode mode, size_t cache_blocks)
     : mount_point(path)
+    , mode(mode)
+    , cache_blocks(cache_blocks)
 {
     this->load_image();
-    this->scan_bitmap();
+    if (!meta_data.clean) { // Crashed Or Killed Last Time.
+        std::cerr << "Image Was Not Cleanly Unmounted, Rebuilding Bitmaps : " << mount_point << std::endl;
+        this->scan_bitmap();
+    }
+
+    // Until Unmounted, The Bitmaps On Disk May Lag Behind.
+    meta_data.clean = false;
+    write_header();
+    image.flush();
 }
 
-filesystem::filesystem(int count_blocks, const std::string& path)
+filesystem::filesystem(int count_blocks, const std::string& path, storage_mode mode, block_mapping mapping, size_t cache_blocks)
     : mount_point(path)
+    , mode(mode)
+    , cache_blocks(cache_blocks)
 {
-    this->create_image(count_blocks);
+    this->create_image(count_blocks, mapping);
 }
 
 void filesystem::mark_bitmap(int inode_id)
@@ -341,29 +521,21 @@ void filesystem::mark_bitmap(int inode_id)
     auto root = inode_list[inode_id];
     assert(root.valid);
 
-    inode_bitmap.at(inode_id) = true;
+    inode_bitmap.set(inode_id);
 
-    if (root.is_dir()) {
-        int i = 2; // For dir.
-        while (i < root.direct_block.size() && root.direct_block[i] != kNULL)
-            mark_bitmap(root.direct_block[i]);
+    if (root.is_dir()) { // For dir.
+        visit_dir_blocks(root, [this](int block_index) { block_bitmap.set(block_index); });
+        visit_dir_entries(root, [this](const dir_entry& entry) { mark_bitmap(entry.inode_id); });
     } else { // For file.
-        int i = 1;
-        while (i < root.direct_block.size() && root.direct_block[i] != kNULL)
-            block_bitmap[root.direct_block[i]] = true;
-        if (root.direct_block[i] != kNULL) {
-            // Linked List Mode.
-            auto block = block_list[root.direct_block[i]];
-            while (block.next != kNULL) {
-                block_bitmap[block.next] = true;
-                block = block_list[block.next];
-            }
-        }
+        visit_blocks(root, [this](int block_index) { block_bitmap.set(block_index); });
     }
 }
 
 void filesystem::scan_bitmap()
 {
+    inode_bitmap = bitmap(meta_data.inode_total);
+    block_bitmap = bitmap(meta_data.block_total);
+    block_bitmap.set(0); // Block 0 Is Reserved As kNULL.
     mark_bitmap(0);
 }
 
@@ -374,152 +546,313 @@ int filesystem::filehander::node_id() const
 
 std::string filesystem::filehander::read(int size) const
 {
-    std::string ret;
-    const auto& inode = m_fs_ref.inode_list[m_inode_id];
-
-    assert(inode.valid);
-    assert(!inode.is_dir());
-    assert(inode.unix_time != 0);
+    std::string ret(std::max(size, 0), '\0');
+    read_into(ret.data(), ret.size());
+    return ret;
+}
 
-    if (m_seekp + size > inode.size)
-        throw std::logic_error(
-            "Overflow When Reading File. Your File Only Has " + std::to_string(inode.size) + " Bytes. But You Want To Read " + std::to_string(size) + " Bytes From Point " + std::to_string(m_seekp));
+size_t filesystem::filehander::read_into(char* buf, size_t size) const
+{
+    const struct iovec iov { buf, size };
+    return readv(&iov, 1);
+}
 
-    int curr_point = 0;
-    for (int i = 1; i < inode.direct_block.size(); ++i) {
-        if (inode.direct_block[i] == kNULL) {
-            if (curr_point != m_seekp + size)
-                throw std::logic_error("No Enough Space To Read!");
-            else
-                break;
+size_t filesystem::filehander::readv(const struct iovec* iov, int iovcnt) const
+{
+    metrics::scoped_timer timer(m_fs_ref.op_metrics, metric_op::read);
+    flush_pending(); // Read What This Handle Wrote.
+
+    std::shared_lock ns_lock(m_fs_ref.namespace_lock);
+    std::shared_lock inode_lock(m_fs_ref.inode_locks[m_inode_id]);
+
+    size_t size = 0;
+    for (int k = 0; k < iovcnt; ++k)
+        size += iov[k].iov_len;
+    check_range(size);
+    read_ahead(size);
+
+    int k = 0;
+    size_t filled = 0; // Bytes Filled In iov[k].
+    for (auto chunk : chunks(size)) {
+        while (!chunk.empty()) {
+            if (filled == iov[k].iov_len) {
+                ++k, filled = 0;
+                continue;
+            }
+            const size_t count = std::min(chunk.size(), iov[k].iov_len - filled);
+            std::memcpy(static_cast<char*>(iov[k].iov_base) + filled, chunk.data(), count);
+            chunk.remove_prefix(count);
+            filled += count;
         }
+    }
+    inode_lock.unlock();
+    ns_lock.unlock();
 
-        const auto& blk = m_fs_ref.block_list[inode.direct_block[i]]; // This Block Is Readable!
-        if (curr_point + blk.size >= m_seekp) { // Now We Can Read!
-            if (curr_point > m_seekp + size) // No More Bytes To Read...
-                break;
-            int bytes_to_read_in_this_block = std::min(blk.size, m_seekp + size - curr_point);
-            std::string_view data_view(blk.data_content, bytes_to_read_in_this_block);
-            ret += data_view;
-            curr_point += bytes_to_read_in_this_block;
-        }
+    m_fs_ref.relieve_cache();
+    m_fs_ref.op_metrics.add_read(size);
+    return size;
+}
+
+void filesystem::filehander::read_ahead(size_t size) const
+{
+    auto& cache = m_fs_ref.block_list;
+    if (cache.is_view() || size == 0)
+        return;
+
+    const auto& inode = m_fs_ref.inode_list[m_inode_id];
+    const int first = m_seekp / data_block::kContentSize;
+    const int last = (m_seekp + size - 1) / data_block::kContentSize + 1;
+    const int file_blocks = (inode.size + data_block::kContentSize - 1) / data_block::kContentSize;
+
+    if (m_seekp == m_ra_next) {
+        // Keep The Window Well Below The Capacity, Or Blocks Are Evicted Before They Are Read.
+        const int max_window = cache.capacity() == 0 ? kMaxReadahead : std::clamp<int>(cache.capacity() / 4, 1, kMaxReadahead);
+        m_ra_window = std::min(std::max(m_ra_window * 2, kMinReadahead), max_window);
+    } else {
+        m_ra_window = 0;
+        m_ra_until = 0;
     }
+    m_ra_next = m_seekp + size;
+
+    // Extend Only Once Half The Window Is Consumed, So Each Read Ahead Goes Out As One Large Batch.
+    int end = last;
+    if (m_ra_window > 0 && m_ra_until - last < m_ra_window / 2)
+        end = std::min(last + m_ra_window, file_blocks);
+    const int begin = std::max(first, m_ra_until);
+    if (begin >= end)
+        return;
+    m_ra_until = std::max(m_ra_until, end);
 
-    if (curr_point < size) { // Still Need Read in Linked List Mode.
-        const auto& last_block = m_fs_ref.block_list[inode.direct_block.back()];
-        assert(last_block.size == last_block.kContentSize);
-        assert(last_block.next != kNULL);
-        int next_index = last_block.next;
-        do {
-            const auto& blk = m_fs_ref.block_list[next_index];
-            int bytes_to_read_in_this_block = std::min(blk.size, m_seekp + size - curr_point);
-
-            std::string_view data_view(blk.data_content, bytes_to_read_in_this_block);
-
-            ret += data_view;
-            curr_point += bytes_to_read_in_this_block;
-            next_index = blk.next;
-        } while (curr_point < size && next_index != kNULL);
+    std::vector<int> ids;
+    for (int nth = begin; nth < end;) {
+        const auto run = m_fs_ref.block_run(inode, nth);
+        if (run.start == kNULL)
+            break;
+        const int count = std::min(run.logical + run.length, end) - nth;
+        for (int i = 0; i < count; ++i)
+            ids.push_back(run.start + (nth - run.logical) + i);
+        nth += count;
     }
+    cache.prefetch(m_fs_ref.io, ids);
+}
 
-    assert(ret.size() == size);
-    return ret;
+filesystem::filehander::chunk_range filesystem::filehander::chunks(size_t size) const
+{
+    flush_pending();
+    check_range(size);
+    return { chunk_iterator(&m_fs_ref, &m_fs_ref.inode_list[m_inode_id], m_seekp, size) };
 }
 
-void filesystem::filehander::write(const std::string_view data)
-{ // Currently This Is Implemented In Append Fashion.
-    int read_index = 0;
-    auto& inode = m_fs_ref.inode_list[m_inode_id];
+void filesystem::filehander::check_range(size_t size) const
+{
+    const auto& inode = m_fs_ref.inode_list[m_inode_id];
 
     assert(inode.valid);
     assert(!inode.is_dir());
     assert(inode.unix_time != 0);
 
-    inode.size += data.size();
+    if (m_seekp < 0 || m_seekp + size > static_cast<size_t>(inode.size))
+        throw std::logic_error(
+            "Overflow When Reading File. Your File Only Has " + std::to_string(inode.size) + " Bytes. But You Want To Read " + std::to_string(size) + " Bytes From Point " + std::to_string(m_seekp));
+}
 
-    int index_in_inode = 1;
-    for (; index_in_inode < inode.direct_block.size(); ++index_in_inode) {
-        if (inode.direct_block[index_in_inode] == kNULL) {
-            // Check If Current Block Is The Answer.
-            if (index_in_inode == 1 || m_fs_ref.block_list[inode.direct_block[index_in_inode - 1]].size == data_block::kContentSize)
-                break;
-            --index_in_inode;
-            break;
-        }
-    } // 我晕我都看不懂我写的是啥的 = =...
+filesystem::filehander::chunk_iterator::chunk_iterator(const filesystem* fs, const inode* node, int offset, size_t size)
+    : m_fs(fs)
+    , m_node(node)
+    // Every Block But The Tail Is Full, So The Offset Maps Straight To Its Block.
+    , m_nth(offset / data_block::kContentSize)
+    , m_begin_in_block(offset % data_block::kContentSize)
+    , m_remaining(size)
+{
+    ++*this;
+}
+
+filesystem::filehander::chunk_iterator& filesystem::filehander::chunk_iterator::operator++()
+{
+    if (m_remaining == 0) {
+        m_chunk = {};
+        return *this;
+    }
+
+    // Stream Through The Physically Contiguous Run, Looking Up The Mapping Once Per Run.
+    if (m_run.start == kNULL || m_nth >= m_run.logical + m_run.length) {
+        m_run = m_fs->block_run(*m_node, m_nth);
+        if (m_run.start == kNULL)
+            throw std::logic_error("No Enough Space To Read!");
+    }
 
-    // Pad The Unfilled Block.
-    if (index_in_inode < inode.direct_block.size() && inode.direct_block[index_in_inode] != kNULL) { // This Means Padding.
-        auto& blk = m_fs_ref.block_list[inode.direct_block[index_in_inode]];
-        assert(blk.size != data_block::kContentSize);
+    const auto& blk = m_fs->block_list[m_run.start + (m_nth - m_run.logical)]; // This Block Is Readable!
+    const size_t count = std::min<size_t>(blk.size - m_begin_in_block, m_remaining);
+    assert(count > 0);
+    m_chunk = std::string_view(blk.data_content + m_begin_in_block, count);
+    m_remaining -= count;
+    m_begin_in_block = 0;
+    ++m_nth;
+    return *this;
+}
 
-        const int read_amount = std::min(blk.kContentSize - blk.size, static_cast<int>(data.size() - read_index));
-        data.copy(blk.data_content + blk.size, read_amount);
-        read_index += read_amount;
-        blk.size += read_amount;
+filesystem::filehander::filehander(filehander&& other) noexcept
+    : m_fs_ref(other.m_fs_ref)
+    , m_inode_id(other.m_inode_id)
+    , m_generation(other.m_generation)
+    , m_seekp(other.m_seekp)
+    , m_ra_next(other.m_ra_next)
+    , m_ra_window(other.m_ra_window)
+    , m_ra_until(other.m_ra_until)
+    , m_pending(std::exchange(other.m_pending, {}))
+    , m_tail(other.m_tail)
+{
+}
 
-        ++index_in_inode;
+filesystem::filehander::~filehander()
+{
+    try {
+        flush_pending();
+    } catch (const std::exception& err) {
+        std::cerr << "Cannot Flush File : " << err.what() << std::endl;
     }
+}
 
-    // Entire Blocks.
-    int left_amount = data.size() - read_index;
-    int blk_num_needed = (left_amount + data_block::kContentSize - 1) / data_block::kContentSize;
+void filesystem::filehander::write(const std::string_view data)
+{
+    metrics::scoped_timer timer(m_fs_ref.op_metrics, metric_op::write);
+    constexpr size_t capacity = kWriteBufferBlocks * data_block::kContentSize;
+    if (m_pending.empty() && data.size() >= capacity) { // Large Writes Skip The Copy.
+        append(data);
+        return;
+    }
 
-    if (blk_num_needed == 0)
+    m_pending.append(data);
+    if (m_pending.size() < capacity)
         return;
 
-    // Allocate Blocks.
-    std::vector<int> blk_indexes{};
-    for (int i = 1; i < m_fs_ref.block_bitmap.size() && blk_indexes.size() < blk_num_needed; ++i) {
-        if (!m_fs_ref.block_bitmap[i])
-            blk_indexes.push_back(i);
+    try {
+        write_pending();
+    } catch (...) {
+        if (!m_pending.empty()) // Nothing Reached The File, So This Write Fails As A Whole. Unless It Was Deleted.
+            m_pending.resize(m_pending.size() - data.size());
+        throw;
     }
+    m_fs_ref.auto_commit(); // The Data Is In The File Now, So A Failure Here Is Only About Durability.
+}
 
-    if (blk_indexes.size() < blk_num_needed)
-        throw std::logic_error("Blocks Not Enough! " + std::to_string(blk_num_needed - blk_indexes.size()) + " required.");
+void filesystem::filehander::flush()
+{
+    flush_pending();
+}
 
-    // Mark the bitmap.
-    for (int ind : blk_indexes)
-        m_fs_ref.block_bitmap[ind] = true;
+void filesystem::filehander::flush_pending() const
+{
+    if (m_pending.empty())
+        return;
+    write_pending();
+    m_fs_ref.auto_commit();
+}
 
-    // Fill the blocks.
-    int link_index = 0;
+void filesystem::filehander::write_pending() const
+{
+    // The Whole Buffer Goes In One Append, So Records Of Concurrent Appenders Never Interleave.
+    std::shared_lock ns_lock(m_fs_ref.namespace_lock);
+    std::unique_lock inode_lock(m_fs_ref.inode_locks[m_inode_id]);
+    if (!alive())
+        m_pending.clear(); // There Is No File To Write Them To Anymore.
+    write_at(m_pending, m_fs_ref.inode_list[m_inode_id].size);
+    m_pending.clear();
+}
 
-    // Connect the indexes in the inode.
-    for (; index_in_inode < inode.direct_block.size() && link_index < blk_indexes.size(); ++index_in_inode) {
-        inode.direct_block[index_in_inode] = blk_indexes[link_index++];
-    }
+bool filesystem::filehander::alive() const
+{
+    return m_fs_ref.inode_list[m_inode_id].valid && m_fs_ref.inode_generations[m_inode_id] == m_generation;
+}
 
-    if (index_in_inode == inode.direct_block.size()) { // Linked List Mode.
-        // Let's Find The Tail First.
-        int next_blk_id = inode.direct_block.back();
+void filesystem::filehander::pwrite(const std::string_view data, int offset)
+{
+    metrics::scoped_timer timer(m_fs_ref.op_metrics, metric_op::write);
+    flush_pending(); // Keep Writes In Order.
+
+    std::shared_lock ns_lock(m_fs_ref.namespace_lock);
+    std::unique_lock inode_lock(m_fs_ref.inode_locks[m_inode_id]);
+    write_at(data, offset);
+    inode_lock.unlock();
+    ns_lock.unlock();
+    m_fs_ref.auto_commit();
+}
 
-        while (true) {
-            auto& blk = m_fs_ref.block_list[next_blk_id];
-            if (blk.next != kNULL)
-                next_blk_id = blk.next;
-            else
-                break;
-        }
+void filesystem::filehander::append(const std::string_view data)
+{
+    std::shared_lock ns_lock(m_fs_ref.namespace_lock);
+    std::unique_lock inode_lock(m_fs_ref.inode_locks[m_inode_id]); // Concurrent Appends Never Share An Offset.
+    write_at(data, m_fs_ref.inode_list[m_inode_id].size);
+    inode_lock.unlock();
+    ns_lock.unlock();
+    m_fs_ref.auto_commit();
+}
 
-        // Now:: next_blk_id is a node without a valid next.
-        for (; link_index < blk_indexes.size(); ++link_index) {
-            auto& blk = m_fs_ref.block_list[next_blk_id];
-            next_blk_id = blk.next = blk_indexes[link_index];
-        }
-    }
+void filesystem::filehander::write_at(const std::string_view data, int offset) const
+{
+    auto& inode = m_fs_ref.inode_list[m_inode_id];
+
+    if (!alive()) // Its Blocks Are Free, And The Inode May Belong To Another File By Now.
+        throw std::logic_error("File Was Deleted While Still Open! Nothing Is Written.");
+    assert(inode.valid);
+    assert(!inode.is_dir());
+    assert(inode.unix_time != 0);
 
-    // * Checked. This piece of codes is OK.
-    for (const auto& ind : blk_indexes) { // Fill The Contents. // !Size
-        auto& blk = m_fs_ref.block_list[ind];
-        const int read_amount = std::min(blk.kContentSize, static_cast<int>(data.size() - read_index));
-        std::string_view data_(data.begin() + read_index, data.size() - read_index);
-        data_.copy(blk.data_content, read_amount);
-        blk.size = read_amount;
-        read_index += read_amount;
+    if (offset < 0 || offset > inode.size)
+        throw std::logic_error(
+            "Cannot Write At Point " + std::to_string(offset) + ". Your File Only Has " + std::to_string(inode.size) + " Bytes.");
+
+    // Map Blocks Past EOF First, So Running Out Of Space Leaves The File Untouched.
+    const int end_point = offset + data.size();
+    const int needed = (end_point + data_block::kContentSize - 1) / data_block::kContentSize;
+    if (!tail_covers(needed - 1)) // Mapped Blocks Form A Prefix Of The File, So Otherwise They Are All There.
+        m_fs_ref.reserve_blocks(m_inode_id, needed);
+
+    write_mapped(data, offset);
+    m_fs_ref.op_metrics.add_written(data.size());
+    if (end_point > inode.size) {
+        inode.size = end_point;
+        m_fs_ref.mark_dirty_inode(m_inode_id);
     }
+}
+
+void filesystem::filehander::fallocate(int length)
+{
+    flush_pending();
+    std::shared_lock ns_lock(m_fs_ref.namespace_lock);
+    std::unique_lock inode_lock(m_fs_ref.inode_locks[m_inode_id]);
+    m_fs_ref.reserve_blocks(m_inode_id, (length + data_block::kContentSize - 1) / data_block::kContentSize);
+    inode_lock.unlock();
+    ns_lock.unlock();
+    m_fs_ref.auto_commit();
+}
 
-    assert(read_index == data.size());
+void filesystem::filehander::write_mapped(const std::string_view data, int offset) const
+{
+    const auto& inode = m_fs_ref.inode_list[m_inode_id];
+
+    // Every Block But The Tail Is Full, So The Offset Maps Straight To Its Block.
+    int nth = offset / data_block::kContentSize;
+    int begin_in_block = offset % data_block::kContentSize;
+    size_t written = 0;
+    while (written < data.size()) {
+        if (!tail_covers(nth)) // Appends Mostly Land In The Run Written Last Time.
+            m_tail = m_fs_ref.block_run(inode, nth);
+        if (m_tail.start == kNULL)
+            throw std::logic_error("No Enough Space To Write!");
+
+        for (int i = nth - m_tail.logical; i < m_tail.length && written < data.size(); ++i) {
+            const int blk_id = m_tail.start + i;
+            auto& blk = m_fs_ref.block_list[blk_id];
+            const int count = std::min<int>(blk.kContentSize - begin_in_block, data.size() - written);
+            data.substr(written, count).copy(blk.data_content + begin_in_block, count);
+            blk.size = std::max(blk.size, begin_in_block + count);
+            m_fs_ref.mark_dirty_block(blk_id);
+            begin_in_block = 0;
+            written += count;
+        }
+        nth = m_tail.logical + m_tail.length;
+    }
 }
 
 void filesystem::filehander::seekp(int p)
@@ -1,47 +1,205 @@
 #pragma once
 
+#include "details/bitmap.hpp"
+#include "details/block_cache.hpp"
 #include "details/data_block.hpp"
+#include "details/dentry_cache.hpp"
+#include "details/dir_bucket.hpp"
+#include "details/dirty_set.hpp"
+#include "details/extent.hpp"
+#include "details/image_file.hpp"
 #include "details/inode.hpp"
+#include "details/io_engine.hpp"
+#include "details/journal.hpp"
+#include "details/metrics.hpp"
 #include "details/super_block.hpp"
+#include "details/table.hpp"
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string_view>
+#include <sys/uio.h>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace jrfs {
 
+/// \brief 镜像的存储方式
+enum class storage_mode {
+    stream, ///< 挂载时只读入inode，数据块在首次访问时读入有界缓存；修改先提交到日志，同步时再写回原处
+    mmap, ///< 将镜像映射进内存，inode_list与block_list直接是映射的视图，同步时只msync脏页
+};
+
 /// \brief　文件系统类，包含对整个文件系统的系统调用
+/// \note 高层API与filehander可被多个线程并发调用。加锁顺序为：
+/// commit_lock → namespace_lock → inode_locks（多把时按下标升序） → dirty_lock。
+/// 增删文件（夹）、同步与组装日志事务时独占namespace_lock；其余操作共享它，再按需对所涉及的inode加读锁或写锁，
+/// 因此不同文件可以并行读写。block与inode的分配由bitmap自身无锁地完成。[底层API]均不加锁，由调用者负责。
+/// \note stream模式下，修改文件系统的高层API与filehander的pwrite、fallocate、flush返回前都会把修改提交到日志并落盘，
+/// 崩溃后再次挂载时重放日志即可恢复；同时返回的多个操作共享同一次落盘（group commit）。
+/// 一次提交大于日志区时，新分配的数据块先不经日志写回原处，其余部分再写入日志（ordered模式），仍是原子的；
+/// 只有对已有数据块的覆盖写本身就大于日志区时才退化为直接写回原处而不保证原子性，并计入stats()的unjournaled_commits。
+/// filehander::write可能只把数据留在句柄的缓冲区中，要等到flush()、句柄析构（或缓冲区攒满）时才落盘。
 struct filesystem {
     /// \brief 构造函数，读取镜像
     /// \param path 一级文件系统路径
-    filesystem(const std::string& path); // Load filesystem;
+    /// \param mode 镜像的存储方式
+    /// \param cache_blocks stream模式下常驻内存的数据块个数上限，0表示不限
+    filesystem(const std::string& path, storage_mode mode = storage_mode::stream, size_t cache_blocks = 0); // Load filesystem;
 
     /// \brief 构造函数，产生镜像
     /// \param count_blocks
     /// \param path 一级文件系统路径
-    filesystem(int count_blocks, const std::string& path); // Create filesystem;
+    /// \param mode 镜像的存储方式
+    /// \param mapping 文件数据块的映射方式
+    /// \param cache_blocks stream模式下常驻内存的数据块个数上限，0表示不限
+    filesystem(int count_blocks, const std::string& path, storage_mode mode = storage_mode::stream, block_mapping mapping = block_mapping::extent, size_t cache_blocks = 0); // Create filesystem;
 
-    /// \brief 文件系统析构函数，会最后对文件系统进行一次整体同步
+    /// \brief 文件系统析构函数，会最后对文件系统进行一次整体同步，并标记镜像为正常卸载
     ~filesystem();
 
+    /// \brief RAII批处理：存续期间本线程修改文件系统的操作都不再各自落盘，
+    /// 本线程最外层的批处理结束时把这些修改作为一个事务一次提交，适合大量细小的追加与增删
+    /// \note 只影响创建它的线程，也须在该线程中结束。其他线程的操作照常在返回前落盘，
+    /// 同一次提交会顺带把批处理中已做的修改一并落盘
+    class batch {
+    public:
+        /// \param fs 文件系统
+        explicit batch(filesystem& fs);
+
+        batch(const batch&) = delete;
+        batch& operator=(const batch&) = delete;
+
+        /// \brief 尚未commit()时结束批处理，是本线程最外层的批处理则提交；提交失败只打印错误，不抛出异常
+        ~batch();
+
+        /// \throws std::logic_error
+        /// \brief 结束批处理并立即提交，之后析构不再提交
+        void commit();
+
+    private:
+        filesystem* m_fs; ///< 已结束时为nullptr
+    };
+
     /// \brief 文件系统用于操控文件读写的API，类似于Cpp的std::fstream和C标准库的fread或fwrite操作
+    /// \note 追加写先攒在句柄的缓冲区中，攒满或flush()、读取、定点写入及析构时才写入文件。
+    /// 句柄只能移动不能复制，且须在文件系统之前析构
     struct filehander {
 
+        /// 按数据块顺序产出文件某一字节区间的迭代器，每次产出直接指向data_content的string_view
+        /// \note 写入文件、任何修改文件系统的操作（可能淘汰缓存中的数据块）或析构文件系统后，已产出的string_view失效
+        class chunk_iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view*;
+            using reference = const std::string_view&;
+
+            /// 构造尾后迭代器
+            chunk_iterator() = default;
+
+            inline reference operator*() const { return m_chunk; }
+            inline pointer operator->() const { return &m_chunk; }
+
+            /// \throws std::logic_error
+            chunk_iterator& operator++();
+
+            inline chunk_iterator operator++(int)
+            {
+                auto old = *this;
+                ++*this;
+                return old;
+            }
+
+            /// 以剩余未产出的字节数判等，尾后迭代器为0
+            inline bool operator==(const chunk_iterator& other) const { return m_remaining + m_chunk.size() == other.m_remaining + other.m_chunk.size(); }
+            inline bool operator!=(const chunk_iterator& other) const { return !(*this == other); }
+
+        private:
+            friend struct filehander;
+
+            chunk_iterator(const filesystem* fs, const inode* node, int offset, size_t size);
+
+            const filesystem* m_fs = nullptr;
+            const inode* m_node = nullptr;
+            extent m_run { 0, kNULL, 0 }; ///< 当前块所在的连续数据块段
+            int m_nth = 0; ///< 下一个要产出的逻辑块号
+            int m_begin_in_block = 0; ///< 下一个块中的起始偏移
+            size_t m_remaining = 0; ///< 当前块之后尚未产出的字节数
+            std::string_view m_chunk;
+        };
+
+        /// 文件字节区间[seekp, seekp + size)的分块视图，可用于range-for
+        struct chunk_range {
+            chunk_iterator first;
+            inline chunk_iterator begin() const { return first; }
+            inline chunk_iterator end() const { return {}; }
+        };
+
         /// 将文件视为逻辑上的一个byte block，seekp用于选择当前文件读写指针定位
         /// \note 初始化为0
         /// \param p 读写指针定位处
         void seekp(int p);
 
-        /// 向文件写入数据
-        /// \throws std::logic_error
+        /// 向文件末尾追加数据。小块数据先进入句柄的缓冲区，攒满kWriteBufferBlocks个数据块后一起写入并提交；
+        /// 每次调用的数据总是整体写入，并发追加同一文件时不会互相穿插
+        /// \note 返回时数据未必已落盘，须调用flush()或析构句柄
+        /// \throws std::logic_error 缓冲区写入文件时空间不足抛出，此时缓冲区与文件均不被修改；
+        /// 已写入文件但提交失败时抛出提交的错误，此时数据已在文件中，只是尚未落盘
         /// \param data 被写入的数据字节流
         void write(const std::string_view data);
 
+        /// 将缓冲区中的追加数据写入文件，并像其他写操作一样提交（批处理期间随批处理提交），之后其他句柄也能读到
+        /// \throws std::logic_error 空间不足时抛出，此时缓冲区与文件均不被修改；提交失败时抛出提交的错误；
+        /// 文件在打开后已被删除时丢弃缓冲区并抛出，即使其inode已被新文件复用也不会写入
+        void flush();
+
+        /// 从文件的offset处写入数据，原地覆盖已有的数据块，只为超出文件末尾的部分分配新块
+        /// \note 不改变读写指针
+        /// \throws std::logic_error offset超出文件末尾或空间不足时抛出，此时文件不被修改
+        /// \param data 被写入的数据字节流
+        /// \param offset 写入的起始位置，不得大于文件大小
+        void pwrite(const std::string_view data, int offset);
+
+        /// 为文件预分配数据块，使其无需再分配即可增长到length字节；不改变文件大小
+        /// \throws std::logic_error 空间不足时抛出
+        /// \param length 预分配后文件可容纳的字节数
+        void fallocate(int length);
+
         /// 从文件中读取数据
         /// \throws std::logic_error
         /// \param size 读取数据字节流的大小
         /// \return 直接以字符串的形式返回
         std::string read(int size) const;
 
+        /// 从文件中读取数据到调用者提供的缓冲区，不进行任何堆分配
+        /// \throws std::logic_error
+        /// \param buf 目标缓冲区，至少可容纳size字节
+        /// \param size 读取数据字节流的大小
+        /// \return 读取的字节数
+        size_t read_into(char* buf, size_t size) const;
+
+        /// 从文件中连续读取数据并依次分散到多个缓冲区，不进行任何堆分配
+        /// \throws std::logic_error
+        /// \param iov 目标缓冲区数组，语义同readv(2)
+        /// \param iovcnt 缓冲区个数
+        /// \return 读取的字节数，即全部缓冲区长度之和
+        size_t readv(const struct iovec* iov, int iovcnt) const;
+
+        /// 零拷贝地按数据块遍历文件数据
+        /// \note 不加锁：遍历期间调用者须保证没有并发的写入或删除
+        /// \throws std::logic_error
+        /// \param size 遍历数据字节流的大小
+        /// \return 从读写指针开始、长度为size的分块视图
+        chunk_range chunks(size_t size) const;
+
         /// 当前对应的inode下标
         /// \return 当前对应的inode下标
         int node_id() const;
@@ -52,13 +210,57 @@ struct filesystem {
         inline filehander(filesystem& fs, int ind)
             : m_fs_ref(fs)
             , m_inode_id(ind)
+            , m_generation(fs.inode_generations[ind])
         {
         }
 
+        filehander(filehander&& other) noexcept;
+        filehander(const filehander&) = delete;
+
+        /// \brief 写入缓冲区中的数据，失败时输出到标准错误
+        ~filehander();
+
     private:
+        /// \throws std::logic_error 区间超出文件大小时抛出
+        void check_range(size_t size) const;
+
+        /// \throws std::logic_error 空间不足时抛出，此时文件不被修改
+        void append(const std::string_view data);
+
+        /// \return 绑定的文件自打开以来没有被删除（调用者须持有namespace_lock）
+        bool alive() const;
+
+        /// \throws std::logic_error 文件已被删除时抛出
+        /// \brief 不加锁的pwrite
+        void write_at(const std::string_view data, int offset) const;
+
+        /// \brief 将数据写入offset处已映射的数据块，并更新各块的有效长度
+        void write_mapped(const std::string_view data, int offset) const;
+
+        /// \brief 将缓冲区写入文件并提交；读取也须先调用它，以读到本句柄写入的数据
+        void flush_pending() const;
+
+        /// \throws std::logic_error 空间不足时抛出，此时缓冲区与文件均不被修改；文件已被删除时丢弃缓冲区并抛出
+        /// \brief 只将缓冲区写入文件，不提交
+        void write_pending() const;
+
+        /// \param nth 逻辑块号
+        /// \return 上次写入的数据块段是否包含第nth个逻辑块
+        inline bool tail_covers(int nth) const { return m_tail.start != kNULL && nth >= m_tail.logical && nth < m_tail.logical + m_tail.length; }
+
+        /// \brief 按本次读取调整预读窗口：接着上次读取的末尾读时窗口翻倍，否则视为随机访问并收缩为0；
+        /// 再将本次读取与窗口内尚未常驻的数据块批量读入缓存。调用者须持有读锁
+        void read_ahead(size_t size) const;
+
         filesystem& m_fs_ref;
         const int m_inode_id;
+        const uint32_t m_generation; ///< 打开时inode的删除次数，不同则说明文件已被删除，下标可能已被复用
         int m_seekp = 0;
+        mutable int m_ra_next = 0; ///< 顺序读取时下一次读取的起点
+        mutable int m_ra_window = 0; ///< 预读窗口的数据块个数，0表示随机访问
+        mutable int m_ra_until = 0; ///< 已读入缓存的逻辑块号上界（不含）
+        mutable std::string m_pending; ///< 尚未写入文件的追加数据
+        mutable extent m_tail { 0, kNULL, 0 }; ///< 上次写入的数据块段，文件只会增长，故追加时可免去映射查找
     };
 
     /// \throws std::logic_error
@@ -101,56 +303,282 @@ struct filesystem {
     /// \param tokens 路径字符串数组
     /// \param path 源路径（用于报错）
     /// \return inode下标
-    /// \brief [底层API] 将文件（夹）路径转化为inode下标
+    /// \brief [底层API] 将文件（夹）路径转化为inode下标，每一级先查dentry缓存
     int path_to_inode(const std::vector<std::string>& tokens, const std::string& path);
 
     /// \throws std::logic_error
     /// \param path 文件（夹）路径
     /// \return inode下标
-    /// \brief [底层API] 将文件（夹）路径转化为inode下标
-    int path_to_inode(const std::string& path);
+    /// \brief [高层API] 将文件（夹）路径转化为inode下标，完整路径命中缓存时无需拆分路径。
+    /// 完整路径或每一级都命中缓存时不进行堆分配；未命中时要把结果加入缓存，会分配键与表项
+    int path_to_inode(std::string_view path);
+
+    /// \throws std::logic_error
+    /// \param path 文件（夹）路径
+    /// \return inode下标
+    /// \brief [底层API] 同path_to_inode，但不加锁
+    int find_inode(std::string_view path);
+
+    /// \throws std::logic_error
+    /// \param tokens 路径的各级名字，首项须为空（根目录）
+    /// \param path 源路径（用于报错）
+    /// \return inode下标
+    /// \brief [底层API] 逐级查找路径，每一级先查dentry缓存，再查文件夹的哈希桶
+    template <typename Tokens>
+    int resolve_path(const Tokens& tokens, std::string_view path);
 
     /// \throws std::logic_error
     /// \param new_file_name 文件名
     /// \param dir_index 所在文件夹的inode下标
     /// \return inode下标
     /// \brief [底层API] 创建文件inode
-    int create_file_inode(const std::string& new_file_name, int dir_index);
+    int create_file_inode(std::string_view new_file_name, int dir_index);
 
     /// \throws std::logic_error
     /// \param new_dir_name 文件夹名
     /// \param dir_index 当前文件夹的inode下标
     /// \return inode下标
     /// \brief [底层API] 创建文件夹inode
-    int create_dir_inode(const std::string& new_dir_name, int dir_index);
+    int create_dir_inode(std::string_view new_dir_name, int dir_index);
 
     /// \throws std::logic_error
     /// \note 所需的数据信息（如文件位置）已经在filesystem类初始化的时候得到
     /// \brief [底层API] 加载镜像
     void load_image();
 
+    /// \throws std::logic_error
+    /// \brief [底层API] 从镜像的bitmap区读入bitmap
+    void load_bitmap();
+
     /// \throws std::logic_error
     /// \param count_blocks 镜像所需的block的大小
+    /// \param mapping 文件数据块的映射方式
     /// \brief [底层API] 构建镜像
-    void create_image(int count_blocks);
+    void create_image(int count_blocks, block_mapping mapping = block_mapping::extent);
 
     /// \throws std::logic_error
-    /// \brief [底层API] 同步内存与磁盘中的镜像
+    /// \brief [底层API] 同步内存与磁盘中的镜像，只写回上次同步以来被修改过的inode与数据块
     void sync_image();
 
     /// \throws std::logic_error
-    /// \brief [底层API] 检查bitmap和当前文件系统是否一致
+    /// \brief [底层API] 将super block写回镜像头部
+    void write_header();
+
+    /// \return 是否启用日志：镜像带日志区且为stream模式（mmap模式下脏页随时可能被内核写回原处，日志无从保证原子性）
+    bool journaled() const;
+
+    /// \throws std::logic_error
+    /// \brief [高层API] 将上次提交以来的全部修改作为一个事务写入日志并落盘。
+    /// 并发的调用者排队等待，排在前面的一次提交会带走后面调用者的修改，使它们无需再次落盘
+    void commit_journal();
+
+    /// \throws std::logic_error
+    /// \brief [高层API] 使此前的全部修改落盘：启用日志时提交一个事务，否则同步整个镜像。批处理期间也立即提交
+    void commit();
+
+    /// \return 各操作的次数与耗时直方图、读写字节数及分配器扫描长度的副本；编译时未启用JRFS_METRICS则全为0
+    /// \brief [高层API] 读取运行统计，可与其他操作并发调用
+    metrics_snapshot stats() const;
+
+    /// \brief [高层API] 清零运行统计
+    void reset_stats();
+
+    /// \return 修改落盘后就绪的future，落盘失败时其中保存异常
+    /// \brief [高层API] 在后台提交线程中执行commit()，不阻塞调用者；排队中的多个请求共享同一次提交
+    std::future<void> commit_async();
+
+    /// \throws std::logic_error
+    /// \brief [底层API] 修改文件系统的操作结束时调用：本线程没有打开的批处理时提交到日志
+    void auto_commit();
+
+    /// \brief [底层API] 后台提交线程的主循环，直到析构时排空所有请求才退出
+    void run_committer();
+
+    /// \throws std::logic_error
+    /// \brief [底层API] 按CLOCK算法淘汰缓存中的数据块，脏块先写回原处；尚未提交到日志的块不被淘汰。
+    /// 调用者须持有commit_lock并独占namespace_lock，保证没有其他线程持有数据块的引用
+    void evict_blocks();
+
+    /// \throws std::logic_error
+    /// \brief [底层API] 数据块缓存超出容量时加锁淘汰，在不持有任何锁时调用
+    void relieve_cache();
+
+    /// \param fresh 输出：fresh_blocks中被修改过的数据块，已提交的状态不引用它们，可以不经日志写回原处
+    /// \return 由上次提交以来被修改过的其余inode与数据块组成的事务，相邻的合并为一条记录
+    /// \brief [底层API] 组装事务并清空pending_inodes、pending_blocks、fresh_blocks与released_blocks，调用者须独占namespace_lock
+    journal::transaction collect_transaction(journal::transaction& fresh);
+
+    /// \throws std::logic_error
+    /// \param txn 事务
+    /// \param fresh 新分配数据块的修改
+    /// \brief [底层API] 将两者作为一个事务写入日志并落盘；剩余空间不足时先检查点。
+    /// 检查点后仍放不下时按ordered模式提交：先将fresh直接写回原处并落盘，再只将txn写入日志，崩溃时已提交的状态不受影响；
+    /// txn本身也比整个日志区还大时只能直接写回原处（不保证原子性），并计入unjournaled_commits。调用者须持有commit_lock
+    void write_transaction(journal::transaction& txn, journal::transaction& fresh);
+
+    /// \param index inode下标
+    /// \brief [底层API] 标记inode已被修改，下次同步时写回
+    void mark_dirty_inode(int index);
+
+    /// \param index 数据块下标
+    /// \brief [底层API] 标记数据块已被修改，下次同步时写回
+    void mark_dirty_block(int index);
+
+    /// \param index 刚在bitmap中占用的数据块下标
+    /// \brief [底层API] 记录新分配的数据块；本次提交窗口内被释放过的除外，因为已提交的状态可能还引用它
+    void mark_fresh_block(int index);
+
+    /// \param index 数据块下标
+    /// \brief [底层API] 在bitmap中释放已映射过的数据块
+    void release_block(int index);
+
+    /// \throws std::logic_error
+    /// \brief [底层API] 遍历整个目录树重建bitmap，仅在镜像未被正常卸载时需要
     void scan_bitmap();
 
     /// \param inode_id inode下标
     /// \brief [底层API] 标记一个inode（文件夹/文件）下所对应的所有inode和block块
     void mark_bitmap(int inode_id);
 
+    /// \param node 文件inode
+    /// \param nth 逻辑块号
+    /// \return 文件第nth个逻辑块对应的数据块下标，未映射则返回kNULL
+    /// \brief [底层API] extent映射下通过inode内联的extent与溢出的extent树以O(log n)完成转换，间接块映射下为O(1)
+    int block_id(const inode& node, int nth) const;
+
+    /// \param node 文件inode
+    /// \param nth 逻辑块号
+    /// \return 从第nth个逻辑块开始、物理上连续的一段数据块；start为kNULL表示未映射
+    /// \brief [底层API] 供顺序读取按段推进，避免逐块查找映射
+    extent block_run(const inode& node, int nth) const;
+
+    /// \param node 文件inode
+    /// \return 文件已映射的数据块个数
+    int block_count(const inode& node) const;
+
+    /// \throws std::logic_error
+    /// \param inode_id 文件inode下标
+    /// \param block_ids 已在bitmap中占用的数据块，物理上连续的部分会被合并为同一个extent
+    /// \param map_blocks 已在bitmap中占用、供新建extent树节点或间接索引块使用的数据块，用掉的被移出
+    /// \brief [底层API] 将数据块依次映射到文件末尾
+    void append_blocks(int inode_id, const std::vector<int>& block_ids, std::vector<int>& map_blocks);
+
+    /// \throws std::logic_error 空间不足时抛出，此时bitmap与文件的映射都不被修改
+    /// \param inode_id 文件inode下标
+    /// \param count 文件至少需要映射的数据块个数
+    /// \brief [底层API] 为文件分配并映射数据块直至共有count个，优先紧接文件最后一个数据块分配连续的段。
+    /// 映射所需的extent树节点或间接索引块与数据块一并预先占用，映射开始后不会再因空间不足而失败
+    void reserve_blocks(int inode_id, int count);
+
+    /// \param node 文件inode
+    /// \param mapped 文件已映射的数据块个数
+    /// \param count 映射后的数据块个数
+    /// \param runs 新数据块中物理上连续的段数
+    /// \return 映射新数据块最多需要新建的extent树节点或间接索引块个数
+    int map_blocks_needed(const inode& node, int mapped, int count, int runs) const;
+
+    /// \param node 文件inode
+    /// \param fn 对每个数据块下标的回调
+    /// \brief [底层API] 遍历文件占用的全部数据块，包括extent树节点或间接索引块
+    void visit_blocks(const inode& node, const std::function<void(int)>& fn) const;
+
+    /// \throws std::logic_error
+    /// \param inode_id 文件inode下标
+    /// \param e 紧接文件末尾的extent
+    /// \param map_blocks 预先占用的数据块，新建节点时优先取用
+    /// \brief [底层API] 将一个extent映射到文件末尾，与末尾extent连续时直接合并
+    void append_extent(int inode_id, const extent& e, std::vector<int>& map_blocks);
+
+    /// \throws std::logic_error
+    /// \param node_id extent树节点所在的数据块下标
+    /// \param e 紧接文件末尾的extent
+    /// \param map_blocks 预先占用的数据块，新建节点时优先取用
+    /// \return 节点已满时新建的右兄弟节点及其起始逻辑块号，否则为{kNULL, 0}
+    /// \brief [底层API] 将extent追加到以node_id为根的子树的最右侧
+    std::pair<int, int> append_to_extent_tree(int node_id, const extent& e, std::vector<int>& map_blocks);
+
+    /// \throws std::logic_error
+    /// \return 新分配并清零的extent树节点或间接索引块的数据块下标
+    int allocate_map_block();
+
+    /// \throws std::logic_error map_blocks为空且空间不足时抛出
+    /// \param map_blocks 预先占用的数据块，非空时取出其末尾一个，否则从bitmap中分配
+    /// \return 清零后的extent树节点或间接索引块的数据块下标
+    int allocate_map_block(std::vector<int>& map_blocks);
+
+    /// \param dir 文件夹inode
+    /// \param name 子文件/子文件夹名
+    /// \return 子节点的inode下标，不存在则返回kNULL
+    /// \brief [底层API] 在文件夹的哈希桶中以O(1)查找子节点
+    int dir_lookup(const inode& dir, std::string_view name) const;
+
+    /// \throws std::logic_error 重名或空间不足时抛出
+    /// \param dir_id 文件夹inode下标
+    /// \param name 子节点名
+    /// \param inode_id 子节点inode下标
+    /// \brief [底层API] 向文件夹加入目录项，负载过高时分裂一个桶
+    void dir_insert(int dir_id, std::string_view name, int inode_id);
+
+    /// \throws std::logic_error 找不到目录项时抛出
+    /// \param dir_id 文件夹inode下标
+    /// \param name 子节点名
+    /// \brief [底层API] 从文件夹移除目录项
+    void dir_remove(int dir_id, std::string_view name);
+
+    /// \param index 文件（夹）inode下标
+    /// \return 沿上级文件夹拼出的完整路径，根目录为"/"
+    std::string inode_path(int index) const;
+
+    /// \param dir 文件夹inode
+    /// \param fn 对每个目录项的回调，回调中不得修改该文件夹
+    /// \brief [底层API] 遍历文件夹的全部目录项
+    void visit_dir_entries(const inode& dir, const std::function<void(const dir_entry&)>& fn) const;
+
+    /// \param dir 文件夹inode
+    /// \param fn 对每个数据块下标的回调
+    /// \brief [底层API] 遍历文件夹占用的全部数据块，包括桶、溢出块与映射自身的块
+    void visit_dir_blocks(const inode& dir, const std::function<void(int)>& fn) const;
+
+    /// \throws std::logic_error
+    /// \param dir_id 文件夹inode下标
+    /// \brief [底层API] 为文件夹追加一个桶，并分裂对应的旧桶
+    void grow_directory(int dir_id);
+
+    /// \throws std::logic_error
+    /// \param head 桶的首个数据块下标
+    /// \param entry 目录项
+    /// \param spare 可复用的空闲溢出块，优先于分配新块使用
+    /// \brief [底层API] 将目录项放入桶中，桶满时链接溢出块
+    void insert_into_bucket(int head, const dir_entry& entry, std::vector<int>* spare = nullptr);
+
     super_block meta_data; ///< 文件系统的元数据
-    const std::string& mount_point; ///< 原来镜像的位置
-    std::vector<char> block_bitmap; ///< 对于全局所有block的标记，如果是空闲的则为0，否则为1
-    std::vector<char> inode_bitmap; ///< 对于全局inode进行标记，如果是空闲的则为0，否则为1
-    std::vector<inode> inode_list; ///< 文件系统inode部分对应内存的映射
-    std::vector<data_block> block_list; ///< 文件系统存储块部分对应内存的映射
+    const std::string mount_point; ///< 原来镜像的位置
+    const storage_mode mode; ///< 镜像的存储方式
+    const size_t cache_blocks; ///< stream模式下常驻内存的数据块个数上限，0表示不限
+    image_file image; ///< 镜像文件（mmap模式下同时被映射进内存）
+    io_engine io; ///< 镜像的批量异步I/O，stream模式下整块读入与写回都经由它
+    bitmap block_bitmap; ///< 对于全局所有block的标记，如果是空闲的则为0，否则为1
+    bitmap inode_bitmap; ///< 对于全局inode进行标记，如果是空闲的则为0，否则为1
+    table<inode> inode_list; ///< 文件系统inode部分对应内存的映射
+    block_cache block_list; ///< 数据块区：stream模式下是按需读入的有界缓存，mmap模式下是映射区的视图
+    dirty_set dirty_inodes; ///< 上次同步以来被修改过的inode
+    dirty_set dirty_blocks; ///< 上次同步以来被修改过的数据块
+    dirty_set pending_inodes; ///< 上次提交以来被修改过的inode（仅启用日志时记录）
+    dirty_set pending_blocks; ///< 上次提交以来被修改过的数据块（仅启用日志时记录）
+    dirty_set fresh_blocks; ///< 上次提交以来新分配、已提交的状态不引用的数据块（仅启用日志时记录）
+    dirty_set released_blocks; ///< 上次提交以来被释放的数据块（仅启用日志时记录）
+    journal wal; ///< 镜像末尾的重做日志
+    dentry_cache dentries; ///< 路径查找缓存（内部自带锁）
+    std::mutex commit_lock; ///< 同一时刻只有一个提交者写日志或同步镜像
+    std::mutex async_lock; ///< 保护async_waiters与stop_committer
+    std::condition_variable async_ready; ///< 有新的异步提交请求或需要退出时通知提交线程
+    std::vector<std::promise<void>> async_waiters; ///< 等待下一次提交的异步请求
+    bool stop_committer = false;
+    std::thread committer; ///< 后台提交线程，首次commit_async()时启动
+    std::shared_mutex namespace_lock; ///< 命名空间锁：增删文件（夹）与同步时独占，其余操作共享
+    std::unique_ptr<std::shared_mutex[]> inode_locks; ///< 每个inode一把读写锁，保护其大小、数据块映射与数据块
+    std::unique_ptr<uint32_t[]> inode_generations; ///< 每个inode被删除的次数（只在内存中），受namespace_lock保护
+    std::mutex dirty_lock; ///< 保护dirty_inodes、dirty_blocks、pending_inodes、pending_blocks、fresh_blocks与released_blocks
+    mutable metrics op_metrics; ///< 运行统计（内部无锁）
 };
 }
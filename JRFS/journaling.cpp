@@ -0,0 +1,209 @@
+#include "filesystem.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace jrfs {
+
+namespace {
+    /// \brief 本线程在各文件系统上尚未结束的批处理层数，没有批处理的文件系统不在其中
+    thread_local std::unordered_map<const filesystem*, int> batch_depth;
+
+    /// \return 结束的是否是本线程在该文件系统上最外层的批处理
+    bool leave_batch(const filesystem* fs)
+    {
+        auto depth = batch_depth.find(fs);
+        assert(depth != batch_depth.end());
+        if (--depth->second > 0)
+            return false;
+        batch_depth.erase(depth);
+        return true;
+    }
+}
+
+bool filesystem::journaled() const
+{
+    return meta_data.journal_blocks > 0 && mode == storage_mode::stream;
+}
+
+void filesystem::commit_journal()
+{
+    if (!journaled())
+        return;
+
+    // Whoever Gets In First Commits For Everyone Queued Behind It: They Then Find Nothing Pending.
+    std::lock_guard commit(commit_lock);
+    std::unique_lock lock(namespace_lock); // Writers Hold It Shared, So The Snapshot Is Consistent.
+    evict_blocks(); // Everything Not Pending Is Durable, So It May Go Home.
+    journal::transaction fresh;
+    auto txn = collect_transaction(fresh);
+    if (txn.empty() && fresh.empty())
+        return;
+
+    // A Checkpoint Rewrites Home Locations, Which Readers Missing The Cache Must Not See Half Done.
+    if (wal.fits(txn.size() + fresh.size()))
+        lock.unlock(); // Others Go On While The Transaction Hits The Disk.
+    write_transaction(txn, fresh);
+
+    if (block_list.over_capacity()) { // What Was Just Committed May Be Evicted Now.
+        if (!lock.owns_lock())
+            lock.lock();
+        evict_blocks();
+    }
+}
+
+journal::transaction filesystem::collect_transaction(journal::transaction& fresh)
+{
+    journal::transaction txn;
+    pending_inodes.for_each_run([&](int begin, int count) {
+        txn.add(meta_data.inode_offset() + static_cast<size_t>(begin) * sizeof(inode), &inode_list[begin], count * sizeof(inode));
+    });
+    pending_inodes.clear();
+
+    pending_blocks.for_each_run([&](int run_begin, int run_count) {
+        const int run_end = run_begin + run_count;
+        for (int begin = run_begin, count; begin < run_end; begin += count) { // Split Further Into Fresh & Other Runs.
+            const bool is_fresh = fresh_blocks.contains(begin);
+            count = 1;
+            while (begin + count < run_end && fresh_blocks.contains(begin + count) == is_fresh)
+                ++count;
+            auto payload = (is_fresh ? fresh : txn).reserve(meta_data.block_offset() + static_cast<size_t>(begin) * sizeof(data_block), count * sizeof(data_block));
+            for (int i = 0; i < count; ++i) // Pending Blocks Are Never Evicted, But Neither Are They Adjacent In Memory.
+                std::memcpy(payload + i * sizeof(data_block), &block_list[begin + i], sizeof(data_block));
+        }
+    });
+    pending_blocks.clear();
+    fresh_blocks.clear();
+    released_blocks.clear();
+    return txn;
+}
+
+void filesystem::write_transaction(journal::transaction& txn, journal::transaction& fresh)
+{
+    if (!wal.fits(txn.size() + fresh.size())) // Checkpoint: Bring Home Locations Up To Date, Then Start The Log Over.
+        wal.replay(image);
+
+    if (wal.fits(txn.size() + fresh.size())) {
+        txn.append(fresh);
+        wal.commit(image, txn);
+        return;
+    }
+
+    // Ordered Mode: No Committed Inode Refers To Fresh Blocks, So They Go Home First And A Crash Before The Commit
+    // Just Leaves Them Free. The Journal Was Emptied Above, So No Older Record Can Overwrite Them On Replay.
+    journal::apply(image, fresh);
+    image.flush();
+    if (wal.fits(txn)) {
+        wal.commit(image, txn);
+        return;
+    }
+
+    // Overwrites Alone Are Larger Than The Whole Journal: Not Atomic.
+    op_metrics.add_unjournaled();
+    journal::apply(image, txn);
+    image.flush();
+}
+
+void filesystem::commit()
+{
+    if (journaled()) {
+        commit_journal();
+        return;
+    }
+    sync_image();
+    image.flush();
+}
+
+void filesystem::auto_commit()
+{
+    if (batch_depth.count(this) == 0 && journaled()) // Batches Of Other Threads Do Not Defer Our Commits.
+        commit_journal();
+    else
+        relieve_cache();
+}
+
+void filesystem::evict_blocks()
+{
+    block_list.trim([this](int id) { return !pending_blocks.contains(id); },
+        [this](int id, const data_block& blk) {
+            if (dirty_blocks.contains(id))
+                image.write(meta_data.block_offset() + static_cast<size_t>(id) * sizeof(data_block), &blk, sizeof(blk));
+        });
+}
+
+void filesystem::relieve_cache()
+{
+    if (!block_list.over_capacity())
+        return;
+    std::lock_guard commit(commit_lock);
+    std::unique_lock lock(namespace_lock);
+    evict_blocks();
+}
+
+std::future<void> filesystem::commit_async()
+{
+    std::lock_guard lock(async_lock);
+    if (!committer.joinable())
+        committer = std::thread(&filesystem::run_committer, this);
+    async_waiters.emplace_back();
+    auto ready = async_waiters.back().get_future();
+    async_ready.notify_one();
+    return ready;
+}
+
+void filesystem::run_committer()
+{
+    std::unique_lock lock(async_lock);
+    for (;;) {
+        async_ready.wait(lock, [this] { return stop_committer || !async_waiters.empty(); });
+        if (async_waiters.empty())
+            return;
+
+        // One Commit Serves Every Request Queued So Far.
+        auto waiters = std::move(async_waiters);
+        async_waiters.clear();
+        lock.unlock();
+        try {
+            commit();
+            for (auto& waiter : waiters)
+                waiter.set_value();
+        } catch (...) {
+            for (auto& waiter : waiters)
+                waiter.set_exception(std::current_exception());
+        }
+        lock.lock();
+    }
+}
+
+filesystem::batch::batch(filesystem& fs)
+    : m_fs(&fs)
+{
+    ++batch_depth[m_fs];
+}
+
+filesystem::batch::~batch()
+{
+    if (m_fs == nullptr)
+        return;
+
+    const bool last = leave_batch(m_fs);
+    try {
+        if (last)
+            m_fs->commit();
+    } catch (const std::exception& err) {
+        std::cerr << "Cannot Commit Batch : " << err.what() << std::endl;
+    }
+}
+
+void filesystem::batch::commit()
+{
+    if (m_fs == nullptr)
+        throw std::logic_error("Batch Already Committed!");
+
+    auto fs = std::exchange(m_fs, nullptr);
+    leave_batch(fs);
+    fs->commit();
+}
+
+}
\ No newline at end of file
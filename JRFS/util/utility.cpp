@@ -2,27 +2,39 @@
 
 namespace jrfs {
 namespace utility {
-    std::vector<std::string> split(std::string strtem, char a)
+    split_view::iterator::iterator(std::string_view str, char delimiter)
+        : m_rest(str)
+        , m_delimiter(delimiter)
+        , m_has_more(true)
+        , m_done(false)
     {
-        using namespace std;
-        if (strtem.size() == 1 && strtem.front() == a)
-            return { "" };
-
-        vector<string> strvec;
-        string::size_type pos1, pos2;
-        pos2 = strtem.find(a);
-        pos1 = 0;
-        while (string::npos != pos2) {
-            strvec.push_back(strtem.substr(pos1, pos2 - pos1));
+        ++*this;
+    }
 
-            pos1 = pos2 + 1;
-            pos2 = strtem.find(a, pos1);
+    split_view::iterator& split_view::iterator::operator++()
+    {
+        if (!m_has_more) {
+            m_done = true;
+            return *this;
         }
 
-        strvec.push_back(strtem.substr(pos1));
+        const auto pos = m_rest.find(m_delimiter);
+        if (pos == std::string_view::npos) {
+            m_token = m_rest;
+            m_has_more = false;
+            m_done = m_token.empty(); // The Trailing Empty Token Is Dropped.
+        } else {
+            m_token = m_rest.substr(0, pos);
+            m_rest.remove_prefix(pos + 1);
+        }
+        return *this;
+    }
 
-        if (strvec.back().empty())
-            strvec.pop_back();
+    std::vector<std::string> split(std::string_view strtem, char a)
+    {
+        std::vector<std::string> strvec;
+        for (auto token : split_view(strtem, a))
+            strvec.emplace_back(token);
         return strvec;
     }
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace jrfs {
@@ -18,6 +21,64 @@ void llwrite(S& stream, const T& v)
 }
 
 namespace utility {
-    std::vector<std::string> split(std::string strtem, char a);
+    /// \brief 惰性拆分字符串，产出指向原字符串的string_view，不进行任何堆分配。
+    /// 拆分规则与split一致：末尾的空串被丢弃，如"/a/b"产出"", "a", "b"，"/"产出""。
+    class split_view {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view*;
+            using reference = const std::string_view&;
+
+            /// 构造尾后迭代器
+            iterator() = default;
+
+            inline reference operator*() const { return m_token; }
+            inline pointer operator->() const { return &m_token; }
+
+            iterator& operator++();
+
+            inline iterator operator++(int)
+            {
+                auto old = *this;
+                ++*this;
+                return old;
+            }
+
+            inline bool operator==(const iterator& other) const { return m_done == other.m_done && (m_done || m_token.data() == other.m_token.data()); }
+            inline bool operator!=(const iterator& other) const { return !(*this == other); }
+
+        private:
+            friend class split_view;
+
+            iterator(std::string_view str, char delimiter);
+
+            std::string_view m_rest; ///< 尚未拆分的部分
+            std::string_view m_token; ///< 当前产出的子串
+            char m_delimiter = '/';
+            bool m_has_more = false; ///< m_rest中是否还有子串
+            bool m_done = true;
+        };
+
+        /// \param str 被拆分的字符串，须比split_view活得更久
+        /// \param delimiter 分隔符
+        inline split_view(std::string_view str, char delimiter)
+            : m_str(str)
+            , m_delimiter(delimiter)
+        {
+        }
+
+        inline iterator begin() const { return iterator(m_str, m_delimiter); }
+        inline iterator end() const { return {}; }
+
+    private:
+        std::string_view m_str;
+        char m_delimiter;
+    };
+
+    std::vector<std::string> split(std::string_view strtem, char a);
 }
 }
\ No newline at end of file
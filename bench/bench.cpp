@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JRFS/filesystem.hpp"
+
+#include <gflags/gflags.h>
+
+DEFINE_string(image, "./jrfs-bench.jrfs", "Scratch image used by the benchmarks, removed afterwards.");
+DEFINE_string(out, "jrfs-bench.json", "File to write the JSON report to.");
+DEFINE_string(filter, "", "Only run benchmarks whose name contains this string.");
+DEFINE_int32(blocks, 65536, "Total numbers of blocks in the largest image.");
+DEFINE_int32(repetitions, 5, "How many times each benchmark is repeated.");
+
+namespace jrfs::bench {
+
+/// \brief 一次测量：计时区间的长度，及其中完成的操作数与读写的字节数
+struct sample {
+    double seconds = 0;
+    long items = 0;
+    size_t bytes = 0;
+};
+
+/// \brief 一项基准测试在全部重复中的统计结果
+struct result {
+    std::string name;
+    std::vector<sample> samples;
+
+    /// \return 每次重复中平均每个操作的纳秒数
+    std::vector<double> ns_per_item() const
+    {
+        std::vector<double> ret;
+        for (const auto& s : samples)
+            ret.push_back(s.seconds * 1e9 / std::max(s.items, 1L));
+        return ret;
+    }
+};
+
+/// \brief 只为被测的部分计时，准备与清理不计入
+class stopwatch {
+public:
+    inline void start() { m_begin = std::chrono::steady_clock::now(); }
+    inline void stop() { m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_begin).count(); }
+    inline double seconds() const { return m_seconds; }
+
+private:
+    std::chrono::steady_clock::time_point m_begin;
+    double m_seconds = 0;
+};
+
+/// \brief 删除暂存镜像
+void remove_image()
+{
+    std::remove(FLAGS_image.c_str());
+}
+
+/// \param size 字节数
+/// \return 可辨认的伪随机内容，读回时可校验
+std::string make_payload(size_t size)
+{
+    std::string ret(size, '\0');
+    std::mt19937 gen(size);
+    for (auto& c : ret)
+        c = static_cast<char>('a' + gen() % 26);
+    return ret;
+}
+
+/// \param blocks 镜像的数据块个数
+/// \return 创建并卸载一个镜像后，挂载与卸载它的耗时
+sample mount_unmount(int blocks)
+{
+    { filesystem fs(blocks, FLAGS_image); }
+
+    stopwatch watch;
+    watch.start();
+    { filesystem fs(FLAGS_image); }
+    watch.stop();
+    return { watch.seconds(), 1, 0 };
+}
+
+/// \return 在根目录下逐个创建文件inode的耗时
+sample create_file_inodes()
+{
+    filesystem fs(FLAGS_blocks, FLAGS_image);
+    const int files = fs.meta_data.inode_total / 2;
+
+    stopwatch watch;
+    watch.start();
+    for (int i = 0; i < files; ++i)
+        fs.create_file_inode("file_" + std::to_string(i), 0);
+    watch.stop();
+    return { watch.seconds(), files, 0 };
+}
+
+/// \param depth 文件所在的目录深度
+/// \return 反复解析同一深度路径的耗时
+sample resolve_paths(int depth)
+{
+    constexpr int kLookups = 100000;
+    filesystem fs(FLAGS_blocks, FLAGS_image);
+    std::string path;
+    for (int i = 0; i < depth; ++i) {
+        path += "/dir_" + std::to_string(i);
+        fs.mkdir(path);
+    }
+    path += "/leaf";
+    fs.fcreate(path);
+
+    stopwatch watch;
+    watch.start();
+    for (int i = 0; i < kLookups; ++i)
+        fs.path_to_inode(path);
+    watch.stop();
+    return { watch.seconds(), kLookups, 0 };
+}
+
+/// \return 用于读测试的文件大小，不超过镜像容量的四分之一
+size_t read_file_size()
+{
+    return std::min<size_t>(16 << 20, static_cast<size_t>(FLAGS_blocks) * data_block::kContentSize / 4);
+}
+
+/// \brief 创建一个写满伪随机内容的文件，供读测试在重新挂载后使用
+void prepare_read_file()
+{
+    filesystem fs(FLAGS_blocks, FLAGS_image);
+    fs.fcreate("/data.bin");
+    fs.fopen("/data.bin").write(make_payload(read_file_size()));
+}
+
+/// \param chunk 每次读取的字节数
+/// \return 重新挂载后从头到尾顺序读取文件的耗时
+sample sequential_read(size_t chunk)
+{
+    prepare_read_file();
+    filesystem fs(FLAGS_image);
+    auto handler = fs.fopen("/data.bin");
+    const size_t size = read_file_size();
+    std::string buffer(chunk, '\0');
+
+    stopwatch watch;
+    watch.start();
+    long reads = 0;
+    for (size_t done = 0; done < size; done += chunk, ++reads) {
+        handler.seekp(done);
+        handler.read_into(buffer.data(), std::min(chunk, size - done));
+    }
+    watch.stop();
+    return { watch.seconds(), reads, size };
+}
+
+/// \param chunk 每次读取的字节数
+/// \return 重新挂载后在随机位置读取文件的耗时
+sample random_read(size_t chunk)
+{
+    prepare_read_file();
+    filesystem fs(FLAGS_image);
+    auto handler = fs.fopen("/data.bin");
+    const size_t size = read_file_size();
+    const long reads = size / chunk;
+    std::string buffer(chunk, '\0');
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> pick(0, size - chunk);
+
+    stopwatch watch;
+    watch.start();
+    for (long i = 0; i < reads; ++i) {
+        handler.seekp(pick(gen));
+        handler.read_into(buffer.data(), chunk);
+    }
+    watch.stop();
+    return { watch.seconds(), reads, reads * chunk };
+}
+
+/// \param chunk 每次追加的字节数
+/// \param total 共追加的字节数
+/// \return 向新文件反复追加的耗时，包括最后将缓冲区写入文件
+sample append_writes(size_t chunk, size_t total)
+{
+    filesystem fs(FLAGS_blocks, FLAGS_image);
+    fs.fcreate("/append.bin");
+    auto handler = fs.fopen("/append.bin");
+    const auto payload = make_payload(chunk);
+
+    stopwatch watch;
+    watch.start();
+    long writes = 0;
+    for (size_t done = 0; done < total; done += chunk, ++writes)
+        handler.write(payload);
+    handler.flush();
+    watch.stop();
+    return { watch.seconds(), writes, writes * chunk };
+}
+
+/// \param dirty 同步前随机改写的数据块个数
+/// \return 将这些修改同步回镜像的耗时
+sample sync_dirty_blocks(int dirty)
+{
+    prepare_read_file();
+    filesystem fs(FLAGS_image);
+    auto handler = fs.fopen("/data.bin");
+    const size_t blocks = read_file_size() / data_block::kContentSize;
+    std::mt19937 gen(7);
+    filesystem::batch batch(fs); // Keep The Per-Write Commits Out Of The Setup.
+    for (int i = 0; i < dirty; ++i)
+        handler.pwrite("x", gen() % blocks * data_block::kContentSize);
+    batch.commit();
+
+    stopwatch watch;
+    watch.start();
+    fs.sync_image();
+    watch.stop();
+    return { watch.seconds(), 1, dirty * sizeof(data_block) };
+}
+
+/// \brief 已注册的基准测试，名称形如`group/argument`
+std::vector<std::pair<std::string, std::function<sample()>>> registry()
+{
+    std::vector<std::pair<std::string, std::function<sample()>>> ret;
+    for (int blocks : { FLAGS_blocks / 16, FLAGS_blocks / 4, FLAGS_blocks })
+        ret.emplace_back("mount_unmount/" + std::to_string(blocks), [blocks] { return mount_unmount(blocks); });
+    ret.emplace_back("create_file_inode", [] { return create_file_inodes(); });
+    for (int depth : { 1, 4, 16 })
+        ret.emplace_back("path_to_inode/depth:" + std::to_string(depth), [depth] { return resolve_paths(depth); });
+    for (size_t chunk : { 4096, 65536 })
+        ret.emplace_back("read/sequential/" + std::to_string(chunk), [chunk] { return sequential_read(chunk); });
+    ret.emplace_back("read/random/4096", [] { return random_read(4096); });
+    ret.emplace_back("write/small/100", [] { return append_writes(100, 1 << 20); });
+    ret.emplace_back("write/large/1048576", [] { return append_writes(1 << 20, 8 << 20); });
+    for (int dirty : { 1, 64, 1024 })
+        ret.emplace_back("sync_image/dirty:" + std::to_string(dirty), [dirty] { return sync_dirty_blocks(dirty); });
+    return ret;
+}
+
+/// \param s 原始字符串
+/// \return JSON字符串字面量
+std::string quoted(const std::string& s)
+{
+    std::string ret = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            ret += '\\';
+        ret += c;
+    }
+    return ret + "\"";
+}
+
+/// \param out 输出流
+/// \param results 全部结果
+/// \brief 以接近Google Benchmark的格式输出JSON报告：每次重复一项，另附mean、median、stddev三项汇总
+void write_json(std::ostream& out, const std::vector<result>& results)
+{
+    char date[32];
+    const auto now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%FT%T%z", std::localtime(&now));
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": " << quoted(date) << ",\n"
+        << "    \"executable\": \"jrfs-bench\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"block_size\": " << sizeof(data_block) << ",\n"
+        << "    \"image_blocks\": " << FLAGS_blocks << ",\n"
+        << "    \"repetitions\": " << FLAGS_repetitions << "\n"
+        << "  },\n  \"benchmarks\": [";
+
+    bool first = true;
+    auto entry = [&](const std::string& name, const std::string& run_type, const std::string& aggregate, long items, double ns, size_t bytes, double seconds) {
+        out << (first ? "\n" : ",\n") << "    {\n"
+            << "      \"name\": " << quoted(aggregate.empty() ? name : name + "_" + aggregate) << ",\n"
+            << "      \"run_name\": " << quoted(name) << ",\n"
+            << "      \"run_type\": " << quoted(run_type) << ",\n";
+        if (!aggregate.empty())
+            out << "      \"aggregate_name\": " << quoted(aggregate) << ",\n";
+        out << "      \"iterations\": " << items << ",\n"
+            << "      \"real_time\": " << ns << ",\n"
+            << "      \"time_unit\": \"ns\",\n"
+            << "      \"items_per_second\": " << (ns > 0 ? 1e9 / ns : 0);
+        if (bytes > 0 && seconds > 0)
+            out << ",\n      \"bytes_per_second\": " << bytes / seconds;
+        out << "\n    }";
+        first = false;
+    };
+
+    for (const auto& r : results) {
+        auto ns = r.ns_per_item();
+        long items = 0;
+        size_t bytes = 0;
+        double seconds = 0;
+        for (size_t i = 0; i < r.samples.size(); ++i) {
+            const auto& s = r.samples[i];
+            entry(r.name, "iteration", "", s.items, ns[i], s.bytes, s.seconds);
+            items += s.items, bytes += s.bytes, seconds += s.seconds;
+        }
+
+        double mean = 0;
+        for (double x : ns)
+            mean += x / ns.size();
+        double variance = 0;
+        for (double x : ns)
+            variance += (x - mean) * (x - mean) / std::max<size_t>(ns.size() - 1, 1);
+        std::sort(ns.begin(), ns.end());
+        const double median = ns.size() % 2 ? ns[ns.size() / 2] : (ns[ns.size() / 2 - 1] + ns[ns.size() / 2]) / 2;
+
+        entry(r.name, "aggregate", "mean", items, mean, bytes, seconds);
+        entry(r.name, "aggregate", "median", items, median, 0, 0);
+        entry(r.name, "aggregate", "stddev", items, std::sqrt(variance), 0, 0);
+    }
+    out << "\n  ]\n}\n";
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    using namespace jrfs::bench;
+
+    std::vector<result> results;
+    for (auto& [name, run] : registry()) {
+        if (name.find(FLAGS_filter) == std::string::npos)
+            continue;
+
+        result r { name, {} };
+        for (int i = 0; i < FLAGS_repetitions; ++i) {
+            r.samples.push_back(run());
+            remove_image();
+        }
+        const auto ns = r.ns_per_item();
+        std::cerr << std::left << std::setw(32) << name << std::right << std::setw(14) << std::fixed << std::setprecision(1)
+                  << *std::min_element(ns.begin(), ns.end()) << " ns/op (best of " << ns.size() << ")\n";
+        results.push_back(std::move(r));
+    }
+
+    std::ofstream out(FLAGS_out);
+    write_json(out, results);
+    std::cerr << "Report Written To " << FLAGS_out << '\n';
+    return out ? 0 : 1;
+}
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include <chrono>
 #include <iostream>
+#include <memory>
 #include <string_view>
 #include <thread>
 
+#include "JRFS/filesystem.hpp"
 #include "JRFS/util/term_style.hpp"
 #include "JRFS/util/utility.hpp"
 
@@ -15,6 +17,16 @@ DEFINE_int32(block_size, 2048, "Total numbers of blocks in new image.");
 namespace jrfs {
 class cli {
 public:
+    cli()
+    {
+        if (FLAGS_mount_path.empty())
+            return;
+        if (FLAGS_create)
+            m_fs = std::make_unique<filesystem>(FLAGS_block_size, FLAGS_mount_path);
+        else
+            m_fs = std::make_unique<filesystem>(FLAGS_mount_path);
+    }
+
     int ls();
     int rm(std::string_view dest);
     int mkdir(std::string_view dest);
@@ -24,6 +36,7 @@ public:
     int echo(std::string_view input);
     int to_jrfs(std::string_view from, std::string_view to);
     int from_jrfs(std::string_view from, std::string_view to);
+    int stats(std::string_view action);
     int exit();
 
     void shell()
@@ -73,6 +86,10 @@ public:
                     if (string_vector.size() != 3)
                         throw std::logic_error("Invalid use of `append`. Run like this: `append ${dest_file} ${string}`");
                     return from_jrfs(string_vector[1], string_vector[2]);
+                } else if (string_vector[0] == "stats") {
+                    if (string_vector.size() > 2 || (string_vector.size() == 2 && string_vector[1] != "reset"))
+                        throw std::logic_error("Invalid use of `stats`. Run like this: `stats` or `stats reset`");
+                    return stats(string_vector.size() == 2 ? string_vector[1] : "");
                 } else if (string_vector[0] == "exit") {
                     if (string_vector.size() != 1)
                         throw std::logic_error("Invalid use of `exit`. Just type `exit` and all.");
@@ -108,6 +125,8 @@ private:
         auto style = pt::WHITE.style({ pt::Style::UNDERLINE, pt::Style::BOLD, pt::Style::REVERSE  });
         std::cout << style << ":: JRFS: RETURN >" << pt::CLEAN << '\t' << code << std::endl;
     }
+
+    std::unique_ptr<filesystem> m_fs; ///< --mount_path指定的镜像，未指定时为nullptr
 };
 }
 
@@ -134,16 +153,29 @@ int cli::echo(std::string_view input)
 
 int cli::exit()
 {
-    for (int i = 0; i < pt::get_term_length(); ++i) {
+    for (size_t i = 0; i < pt::get_term_length(); ++i) {
         std::cout << pt::GREEN.style(pt::Style::BOLD) << '>' << std::flush;
         using namespace std::chrono_literals;
         std::this_thread::sleep_for(5ms);
     }
     std::cout << std::endl;
+    m_fs.reset(); // std::exit Skips Destructors Of Locals.
     std::cout << "Thank U for using JRFS!!!\n";
     std::exit(0);
 }
 
+int cli::stats(std::string_view action)
+{
+    if (m_fs == nullptr)
+        throw std::logic_error("No Image Mounted. Start With --mount_path.");
+    if (action == "reset") {
+        m_fs->reset_stats();
+        return 0;
+    }
+    std::cout << m_fs->stats().report();
+    return 0;
+}
+
 int cli::from_jrfs(std::string_view from, std::string_view to)
 {
     std::cout << __PRETTY_FUNCTION__ << ": Not Implemented.\n";
@@ -0,0 +1,116 @@
+#include <JRFS/details/bitmap.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(Bitmap, CheckSetAndReset)
+{
+    jrfs::bitmap bm(100);
+    EXPECT_EQ(bm.size(), 100);
+    EXPECT_FALSE(bm[42]);
+
+    bm.set(42);
+    EXPECT_TRUE(bm[42]);
+    EXPECT_TRUE(bm.test(42));
+
+    bm.reset(42);
+    EXPECT_FALSE(bm[42]);
+}
+
+TEST(Bitmap, CheckFindFirstZeroAcrossWords)
+{
+    jrfs::bitmap bm(1000);
+    for (int i = 0; i < 700; ++i)
+        bm.set(i);
+
+    EXPECT_EQ(bm.find_first_zero(), 700);
+    EXPECT_EQ(bm.find_first_zero(800), 800);
+
+    bm.reset(65);
+    EXPECT_EQ(bm.find_first_zero(), 65);
+    EXPECT_EQ(bm.find_first_zero(66), 700);
+}
+
+TEST(Bitmap, CheckTailBitsAreNeverFree)
+{
+    jrfs::bitmap bm(70);
+    for (int i = 0; i < 70; ++i)
+        EXPECT_EQ(bm.allocate(), i);
+
+    EXPECT_EQ(bm.find_first_zero(), -1);
+    EXPECT_EQ(bm.allocate(), -1);
+}
+
+TEST(Bitmap, CheckNextFitWrapsAround)
+{
+    jrfs::bitmap bm(200);
+    EXPECT_EQ(bm.allocate(), 0);
+    EXPECT_EQ(bm.allocate(), 1);
+    EXPECT_EQ(bm.allocate(), 2);
+
+    bm.reset(0); // Next Fit Continues After The Last Allocation...
+    EXPECT_EQ(bm.allocate(), 3);
+
+    for (int i = 4; i < 200; ++i)
+        bm.set(i);
+    EXPECT_EQ(bm.allocate(), 0); // ... And Wraps Around When Reaching The End.
+}
+
+TEST(Bitmap, CheckAllocateRun)
+{
+    jrfs::bitmap bm(1000);
+    for (int i = 0; i < 1000; i += 100)
+        bm.set(i); // Free Runs Of 99 Bits.
+
+    // Right At The Goal, Cut Short By The Next Used Bit.
+    EXPECT_EQ(bm.allocate_run(150, 80), std::make_pair(150L, size_t { 50 }));
+    EXPECT_EQ(bm.allocate_run(250, 30), std::make_pair(250L, size_t { 30 }));
+
+    // Used Goal: First Run Long Enough From The Hint, Across Words.
+    EXPECT_EQ(bm.allocate_run(0, 99), std::make_pair(301L, size_t { 99 }));
+    for (int i = 301; i < 400; ++i)
+        EXPECT_TRUE(bm[i]);
+
+    // Nothing Long Enough: The Longest Run Instead.
+    EXPECT_EQ(bm.allocate_run(-1, 500), std::make_pair(401L, size_t { 99 }));
+
+    jrfs::bitmap full(70);
+    EXPECT_EQ(full.allocate_run(-1, 70), std::make_pair(0L, size_t { 70 }));
+    EXPECT_EQ(full.allocate_run(-1, 1), std::make_pair(-1L, size_t { 0 }));
+    EXPECT_EQ(full.find_first_zero(), -1);
+}
+
+TEST(Bitmap, CheckConcurrentAllocationNeverHandsOutABitTwice)
+{
+    constexpr int kThreads = 8;
+    jrfs::bitmap bm(20000);
+    std::vector<std::vector<long>> taken(kThreads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t)
+        workers.emplace_back([&, t] {
+            for (;;) {
+                if (t % 2 == 0) {
+                    const long i = bm.allocate();
+                    if (i < 0)
+                        return;
+                    taken[t].push_back(i);
+                } else {
+                    const auto [start, length] = bm.allocate_run(-1, 7);
+                    if (start < 0)
+                        return;
+                    for (size_t i = 0; i < length; ++i)
+                        taken[t].push_back(start + i);
+                }
+            }
+        });
+    for (auto& worker : workers)
+        worker.join();
+
+    std::vector<int> owners(bm.size(), 0);
+    for (const auto& bits : taken)
+        for (long i : bits)
+            ++owners[i];
+    for (size_t i = 0; i < bm.size(); ++i)
+        ASSERT_EQ(owners[i], 1) << "Bit " << i;
+    EXPECT_EQ(bm.find_first_zero(), -1);
+}
\ No newline at end of file
@@ -33,4 +33,20 @@ TEST(Utility, CheckSplitFunction4)
     std::string src = "/what/the/f/";
     auto tokens = jrfs::utility::split(src, '/');
     EXPECT_TRUE(equal_container(tokens, std::vector<std::string>{ "", "what", "the", "f" }));
+}
+
+TEST(Utility, CheckSplitView)
+{
+    for (std::string src : { "/", "", "/hello.txt", "/what/the/f", "/what/the/f/", "/what//f", "a//", "a" }) {
+        std::vector<std::string> tokens;
+        for (std::string_view token : jrfs::utility::split_view(src, '/')) {
+            EXPECT_GE(token.data(), src.data()); // Views Into The Source.
+            EXPECT_LE(token.data() + token.size(), src.data() + src.size());
+            tokens.emplace_back(token);
+        }
+        EXPECT_EQ(tokens, jrfs::utility::split(src, '/')) << src;
+    }
+
+    EXPECT_EQ(jrfs::utility::split("/what//f", '/'), (std::vector<std::string> { "", "what", "", "f" }));
+    EXPECT_TRUE(jrfs::utility::split("", '/').empty());
 }
\ No newline at end of file
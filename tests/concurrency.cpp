@@ -0,0 +1,70 @@
+#include "test_util.hpp"
+
+#include <thread>
+#include <vector>
+
+TEST(JRFSConcurrency, CheckParallelWritersAndReaders)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    constexpr int kThreads = 8;
+    constexpr int kAppends = 200;
+
+    auto record = [](int t, int i) { return "<" + std::to_string(t) + ":" + std::to_string(i) + ">"; };
+
+    {
+        jrfs::filesystem image(20000, test_image);
+        for (int t = 0; t < kThreads; ++t)
+            image.fcreate("/file_" + std::to_string(t));
+        image.fcreate("/shared");
+
+        // Each Thread Appends To Its Own File And To A Shared One, While Reading Back And Creating Entries.
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t] {
+                auto own = image.fopen("/file_" + std::to_string(t));
+                auto shared = image.fopen("/shared");
+                std::string expected;
+                for (int i = 0; i < kAppends; ++i) {
+                    expected += record(t, i);
+                    own.write(record(t, i));
+                    shared.write(record(t, i));
+                    EXPECT_EQ(expected, own.read(expected.size()));
+                    if (i % 20 == 0)
+                        image.mkdir("/dir_" + std::to_string(t) + "_" + std::to_string(i));
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        // Appends To The Shared File Never Overlap.
+        auto shared = image.fopen("/shared");
+        const int size = image.inode_list[shared.node_id()].size;
+        std::string content = shared.read(size);
+        for (int t = 0; t < kThreads; ++t)
+            for (int i = 0; i < kAppends; ++i)
+                EXPECT_NE(content.find(record(t, i)), std::string::npos);
+
+        size_t total = 0;
+        for (int t = 0; t < kThreads; ++t)
+            for (int i = 0; i < kAppends; ++i)
+                total += record(t, i).size();
+        EXPECT_EQ(size, total);
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        for (int t = 0; t < kThreads; ++t) {
+            std::string expected;
+            for (int i = 0; i < kAppends; ++i)
+                expected += record(t, i);
+            EXPECT_EQ(expected, fs.fopen("/file_" + std::to_string(t)).read(expected.size()));
+            EXPECT_NO_THROW(fs.path_to_inode("/dir_" + std::to_string(t) + "_180"));
+        }
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
\ No newline at end of file
@@ -56,9 +56,10 @@ TEST(JRFSFileAndDir, CheckFileCreation)
 
         auto& inode = image.inode_list[0]; // Get Root.
 
-        EXPECT_NE(inode.direct_block[2], jrfs::kNULL);
+        EXPECT_EQ(inode.size, 1);
+        EXPECT_NE(image.dir_lookup(inode, "lrznb.txt"), jrfs::kNULL);
 
-        auto& file_inode = image.inode_list[inode.direct_block[2]];
+        auto& file_inode = image.inode_list[image.dir_lookup(inode, "lrznb.txt")];
 
         EXPECT_TRUE(file_inode.valid);
         EXPECT_TRUE(!file_inode.is_dir());
@@ -117,7 +118,7 @@ TEST(JRFSFileAndDir, CheckDirectoryCreation)
         EXPECT_TRUE(image.inode_list[dir_index].valid);
         EXPECT_TRUE(image.inode_list[dir_index].is_dir());
         EXPECT_EQ(image.inode_list[dir_index].name, std::string("the"));
-        EXPECT_NE(image.inode_list[dir_index].direct_block[2], jrfs::kNULL);
+        EXPECT_NE(image.dir_lookup(image.inode_list[dir_index], "hello.txt"), jrfs::kNULL);
     }
 
     if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
@@ -273,6 +274,587 @@ TEST(JRFSFileAndDir, CheckBigFileReadWriteVeryComplex)
         EXPECT_EQ(test_message, str);
     }
 
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckFragmentedFileReadWrite)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    constexpr int kAppends = 200; // Enough Extents To Overflow Into A Multi-Level Extent Tree.
+
+    auto block_content = [](char file, int i) {
+        return std::string(jrfs::data_block::kContentSize, static_cast<char>(file + i % 26));
+    };
+
+    {
+        jrfs::filesystem image(1000, test_image);
+
+        EXPECT_NO_THROW(image.fcreate("/a.txt"));
+        EXPECT_NO_THROW(image.fcreate("/b.txt"));
+        auto a = image.fopen("/a.txt");
+        auto b = image.fopen("/b.txt");
+
+        // Interleaved Appends Leave Every File Made Of Single-Block Extents.
+        for (int i = 0; i < kAppends; ++i) {
+            EXPECT_NO_THROW(a.write(block_content('a', i)));
+            EXPECT_NO_THROW(b.write(block_content('A', i)));
+        }
+
+        const auto& file_inode = image.inode_list[a.node_id()];
+        EXPECT_NE(file_inode.direct_block.back(), jrfs::kNULL);
+        EXPECT_EQ(image.block_count(file_inode), kAppends);
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        auto a = fs.fopen("/a.txt");
+
+        std::string expected;
+        for (int i = 0; i < kAppends; ++i)
+            expected += block_content('a', i);
+        EXPECT_EQ(expected, a.read(expected.size()));
+
+        // Reads Crossing Extent Boundaries At Arbitrary Offsets.
+        for (int offset : { 1, 507, 508, 10000, 50000, static_cast<int>(expected.size()) - 600 }) {
+            a.seekp(offset);
+            EXPECT_EQ(expected.substr(offset, 600), a.read(600));
+        }
+
+        fs.fdelete("/a.txt");
+        fs.fdelete("/b.txt");
+
+        // All Blocks Are Free Again.
+        EXPECT_NO_THROW(fs.fcreate("/c.txt"));
+        EXPECT_NO_THROW(fs.fopen("/c.txt").write(std::string(900 * jrfs::data_block::kContentSize, 'c')));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckIndirectMapping)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    constexpr int kBlocks = 300; // Past The Direct And Single Indirect Blocks, Into The Double Indirect One.
+
+    std::string expected;
+    for (int i = 0; i < kBlocks; ++i)
+        expected += std::string(jrfs::data_block::kContentSize, static_cast<char>('a' + i % 26));
+
+    {
+        jrfs::filesystem image(1000, test_image, jrfs::storage_mode::stream, jrfs::block_mapping::indirect);
+
+        EXPECT_NO_THROW(image.fcreate("/a.txt"));
+        auto a = image.fopen("/a.txt");
+        for (int i = 0; i < kBlocks; i += 50)
+            EXPECT_NO_THROW(a.write(expected.substr(i * jrfs::data_block::kContentSize, 50 * jrfs::data_block::kContentSize)));
+
+        const auto& file_inode = image.inode_list[a.node_id()];
+        EXPECT_NE(file_inode.direct_block[18], jrfs::kNULL);
+        EXPECT_NE(file_inode.direct_block[19], jrfs::kNULL);
+        EXPECT_EQ(image.block_count(file_inode), kBlocks);
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        EXPECT_EQ(fs.meta_data.mapping, jrfs::block_mapping::indirect);
+
+        auto a = fs.fopen("/a.txt");
+        EXPECT_EQ(expected, a.read(expected.size()));
+
+        for (int offset : { 1, 17 * 508 - 1, 145 * 508 - 300, 200 * 508 + 7, static_cast<int>(expected.size()) - 600 }) {
+            a.seekp(offset);
+            EXPECT_EQ(expected.substr(offset, 600), a.read(600));
+        }
+
+        fs.fdelete("/a.txt");
+
+        // Data And Index Blocks Are Free Again.
+        EXPECT_NO_THROW(fs.fcreate("/c.txt"));
+        EXPECT_NO_THROW(fs.fopen("/c.txt").write(std::string(900 * jrfs::data_block::kContentSize, 'c')));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckRandomAccessRead)
+{
+    std::string test_image = "./gtest_image.jrfs";
+
+    std::string expected;
+    {
+        jrfs::filesystem image(1000, test_image);
+        EXPECT_NO_THROW(image.fcreate("/a.txt"));
+        auto a = image.fopen("/a.txt");
+
+        // Odd-Sized Appends Keep Padding The Tail Block.
+        for (int i = 0; expected.size() < 100 * jrfs::data_block::kContentSize; ++i) {
+            const std::string piece(7 + i % 300, static_cast<char>('a' + i % 26));
+            EXPECT_NO_THROW(a.write(piece));
+            expected += piece;
+        }
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        auto a = fs.fopen("/a.txt");
+
+        std::srand(2023);
+        for (int i = 0; i < 200; ++i) {
+            const int offset = std::rand() % expected.size();
+            const int size = std::rand() % (expected.size() - offset + 1);
+            a.seekp(offset);
+            EXPECT_EQ(expected.substr(offset, size), a.read(size));
+        }
+
+        a.seekp(expected.size());
+        EXPECT_EQ("", a.read(0));
+        EXPECT_THROW(a.read(1), std::logic_error);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckReadIntoBuffers)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    jrfs::filesystem fs(1000, test_image);
+
+    std::string expected;
+    for (int i = 0; i < 3000; ++i)
+        expected += std::to_string(i) + ',';
+
+    EXPECT_NO_THROW(fs.fcreate("/a.txt"));
+    auto a = fs.fopen("/a.txt");
+    EXPECT_NO_THROW(a.write(expected));
+
+    std::vector<char> buf(2000);
+    a.seekp(1000);
+    EXPECT_EQ(buf.size(), a.read_into(buf.data(), buf.size()));
+    EXPECT_EQ(expected.substr(1000, buf.size()), std::string(buf.data(), buf.size()));
+
+    // Scatter Across Buffers Of Uneven Sizes, Including An Empty One.
+    char head[3], empty[1], mid[700], tail[1500];
+    struct iovec iov[] = { { head, sizeof(head) }, { empty, 0 }, { mid, sizeof(mid) }, { tail, sizeof(tail) } };
+    a.seekp(505);
+    EXPECT_EQ(sizeof(head) + sizeof(mid) + sizeof(tail), a.readv(iov, 4));
+    EXPECT_EQ(expected.substr(505, 3), std::string(head, sizeof(head)));
+    EXPECT_EQ(expected.substr(508, 700), std::string(mid, sizeof(mid)));
+    EXPECT_EQ(expected.substr(1208, 1500), std::string(tail, sizeof(tail)));
+
+    a.seekp(expected.size() - 10);
+    EXPECT_THROW(a.read_into(buf.data(), 11), std::logic_error);
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+}
+
+TEST(JRFSFileAndDir, CheckChunkIteration)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    jrfs::filesystem fs(1000, test_image);
+
+    std::string expected;
+    for (int i = 0; i < 3000; ++i)
+        expected += std::to_string(i) + ',';
+
+    EXPECT_NO_THROW(fs.fcreate("/a.txt"));
+    auto a = fs.fopen("/a.txt");
+    EXPECT_NO_THROW(a.write(expected));
+
+    for (int offset : { 0, 1, 507, 508, 5000 }) {
+        a.seekp(offset);
+        std::string joined;
+        int count = 0;
+        for (std::string_view chunk : a.chunks(expected.size() - offset)) {
+            EXPECT_LE(chunk.size(), jrfs::data_block::kContentSize);
+            joined += chunk;
+            ++count;
+        }
+        EXPECT_EQ(expected.substr(offset), joined);
+        EXPECT_EQ(count, (expected.size() - 1) / jrfs::data_block::kContentSize - offset / jrfs::data_block::kContentSize + 1);
+    }
+
+    // Views Point Into The Image Without Copying.
+    a.seekp(0);
+    const auto range = a.chunks(10);
+    EXPECT_EQ(range.begin()->data(), fs.block_list[fs.block_id(fs.inode_list[a.node_id()], 0)].data_content);
+    EXPECT_EQ(a.chunks(0).begin(), a.chunks(0).end());
+    EXPECT_THROW(a.chunks(expected.size() + 1), std::logic_error);
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+}
+
+TEST(JRFSFileAndDir, CheckPositionalWrite)
+{
+    std::string test_image = "./gtest_image.jrfs";
+
+    std::string expected(5000, 'a');
+    {
+        jrfs::filesystem image(100, test_image);
+        EXPECT_NO_THROW(image.fcreate("/a.txt"));
+        auto a = image.fopen("/a.txt");
+        EXPECT_NO_THROW(a.write(expected));
+        image.sync_image();
+
+        // Overwriting Inside One Block Only Dirties That Block.
+        EXPECT_NO_THROW(a.pwrite("0123456789", 1000));
+        expected.replace(1000, 10, "0123456789");
+        EXPECT_EQ(image.dirty_blocks.size(), 1);
+        EXPECT_TRUE(image.dirty_inodes.empty());
+
+        // Across Block Boundaries.
+        const std::string across(1200, 'b');
+        EXPECT_NO_THROW(a.pwrite(across, 500));
+        expected.replace(500, across.size(), across);
+
+        // Partly Past EOF.
+        const std::string extend(700, 'c');
+        EXPECT_NO_THROW(a.pwrite(extend, expected.size() - 300));
+        expected.replace(expected.size() - 300, 300, extend);
+
+        // Exactly At EOF.
+        EXPECT_NO_THROW(a.pwrite("tail", expected.size()));
+        expected += "tail";
+
+        EXPECT_THROW(a.pwrite("hole", expected.size() + 1), std::logic_error);
+        EXPECT_THROW(a.pwrite("x", -1), std::logic_error);
+
+        // Running Out Of Space Leaves The File Untouched.
+        EXPECT_THROW(a.pwrite(std::string(100 * jrfs::data_block::kContentSize, 'd'), 0), std::logic_error);
+
+        a.seekp(0);
+        EXPECT_EQ(expected, a.read(expected.size()));
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        auto a = fs.fopen("/a.txt");
+        EXPECT_EQ(expected, a.read(expected.size()));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckContiguousAllocation)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string blocks(50 * jrfs::data_block::kContentSize, 'x');
+
+    {
+        jrfs::filesystem image(1000, test_image);
+        EXPECT_NO_THROW(image.fcreate("/a.txt"));
+        EXPECT_NO_THROW(image.fcreate("/b.txt"));
+        auto a = image.fopen("/a.txt");
+        auto b = image.fopen("/b.txt");
+
+        // A Large Append Lands In One Physically Contiguous Run.
+        EXPECT_NO_THROW(a.write(blocks));
+        EXPECT_EQ(image.block_run(image.inode_list[a.node_id()], 0).length, 50);
+
+        // Preallocated Blocks Stay Contiguous Despite Interleaved Appends.
+        EXPECT_NO_THROW(b.fallocate(100 * jrfs::data_block::kContentSize));
+        EXPECT_EQ(image.inode_list[b.node_id()].size, 0);
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_NO_THROW(a.write(std::string(jrfs::data_block::kContentSize, 'a')));
+            EXPECT_NO_THROW(b.write(std::string(jrfs::data_block::kContentSize, 'b')));
+        }
+        const auto& b_inode = image.inode_list[b.node_id()];
+        EXPECT_EQ(image.block_count(b_inode), 100);
+        EXPECT_EQ(image.block_run(b_inode, 0).length, 100);
+
+        // Sequential Appends Continue Right After The Last Block.
+        const int a_blocks = image.block_count(image.inode_list[a.node_id()]);
+        const int a_tail = image.block_id(image.inode_list[a.node_id()], a_blocks - 1);
+        EXPECT_NO_THROW(a.write(blocks));
+        EXPECT_EQ(image.block_id(image.inode_list[a.node_id()], a_blocks), a_tail + 1);
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        auto b = fs.fopen("/b.txt");
+        EXPECT_EQ(std::string(100 * jrfs::data_block::kContentSize, 'b'), b.read(100 * jrfs::data_block::kContentSize));
+
+        // Preallocation Past EOF Is Kept And Freed With The File.
+        EXPECT_NO_THROW(b.fallocate(120 * jrfs::data_block::kContentSize));
+        EXPECT_NO_THROW(b.write("tail"));
+        b.seekp(100 * jrfs::data_block::kContentSize);
+        EXPECT_EQ("tail", b.read(4));
+        fs.fdelete("/a.txt");
+        fs.fdelete("/b.txt");
+        EXPECT_NO_THROW(fs.fcreate("/c.txt"));
+        EXPECT_NO_THROW(fs.fopen("/c.txt").write(std::string(900 * jrfs::data_block::kContentSize, 'c')));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckLargeDirectory)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    constexpr int kEntries = 3000; // Far Beyond One Bucket, Forcing Many Splits.
+
+    auto name_of = [](int i) { return "entry_" + std::to_string(i); };
+
+    {
+        jrfs::filesystem image(40000, test_image);
+        EXPECT_NO_THROW(image.mkdir("/big"));
+        for (int i = 0; i < kEntries; ++i) {
+            if (i % 100 == 0)
+                EXPECT_NO_THROW(image.mkdir("/big/" + name_of(i)));
+            else
+                EXPECT_NO_THROW(image.fcreate("/big/" + name_of(i)));
+        }
+        EXPECT_THROW(image.fcreate("/big/" + name_of(42)), std::logic_error);
+
+        const auto& big = image.inode_list[image.path_to_inode("/big")];
+        EXPECT_EQ(big.size, kEntries);
+        EXPECT_GT(image.block_count(big), kEntries / jrfs::dir_bucket::kMaxEntries);
+
+        int visited = 0;
+        image.visit_dir_entries(big, [&](const jrfs::dir_entry& entry) {
+            EXPECT_EQ(image.inode_list[entry.inode_id].name, entry.view());
+            ++visited;
+        });
+        EXPECT_EQ(visited, kEntries);
+
+        for (int i = 1; i < kEntries; i += 2)
+            EXPECT_NO_THROW(image.fdelete("/big/" + name_of(i)));
+        EXPECT_THROW(image.fcreate("/big/" + name_of(42) + "/nested"), std::logic_error);
+        EXPECT_NO_THROW(image.fcreate("/big/" + name_of(100) + "/nested"));
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        for (int i = 0; i < kEntries; ++i) {
+            if (i % 2 == 1)
+                EXPECT_THROW(fs.path_to_inode("/big/" + name_of(i)), std::logic_error);
+            else
+                EXPECT_EQ(fs.inode_list[fs.path_to_inode("/big/" + name_of(i))].name, name_of(i));
+        }
+        EXPECT_NO_THROW(fs.fopen("/big/" + name_of(100) + "/nested"));
+        EXPECT_EQ(fs.inode_list[fs.path_to_inode("/big")].size, kEntries / 2);
+
+        // Removing The Directory Frees Every Inode And Block Below It.
+        EXPECT_NO_THROW(fs.rmdir("/big"));
+        EXPECT_EQ(fs.inode_list[0].size, 0);
+        for (size_t i = 1; i < fs.inode_bitmap.size(); ++i)
+            EXPECT_FALSE(fs.inode_bitmap[i]);
+        int used_blocks = 0;
+        for (size_t i = 0; i < fs.block_bitmap.size(); ++i)
+            used_blocks += fs.block_bitmap[i];
+        EXPECT_EQ(used_blocks, 2); // The Reserved Block 0 And The Root's Bucket.
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckDentryCache)
+{
+    std::string test_image = "./gtest_image.jrfs";
+
+    {
+        jrfs::filesystem image(1000, test_image);
+        EXPECT_NO_THROW(image.mkdir("/a"));
+        EXPECT_NO_THROW(image.mkdir("/a/b"));
+        EXPECT_NO_THROW(image.fcreate("/a/b/c.txt"));
+
+        const int c = image.path_to_inode("/a/b/c.txt");
+        const size_t hits = image.dentries.hits();
+        for (int i = 0; i < 10; ++i)
+            EXPECT_EQ(image.path_to_inode("/a/b/c.txt"), c);
+        EXPECT_EQ(image.dentries.hits(), hits + 10);
+
+        // A Sibling Path Reuses The Cached Levels.
+        EXPECT_NO_THROW(image.fcreate("/a/b/d.txt"));
+        const size_t misses = image.dentries.misses();
+        EXPECT_NO_THROW(image.fopen("/a/b/d.txt"));
+        EXPECT_EQ(image.dentries.misses(), misses + 2); // The Full Path & The Last Level.
+
+        // Removing An Entry Only Drops The Paths Through It.
+        EXPECT_NO_THROW(image.mkdir("/a/x"));
+        EXPECT_NO_THROW(image.mkdir("/a/xy"));
+        EXPECT_NO_THROW(image.fcreate("/a/x/e.txt"));
+        EXPECT_NO_THROW(image.path_to_inode("/a/x/e.txt"));
+        EXPECT_NO_THROW(image.path_to_inode("/a/xy"));
+        EXPECT_NO_THROW(image.rmdir("/a/x"));
+        const size_t kept = image.dentries.hits();
+        EXPECT_NO_THROW(image.path_to_inode("/a/xy"));
+        EXPECT_NO_THROW(image.path_to_inode("/a/b/d.txt"));
+        EXPECT_EQ(image.dentries.hits(), kept + 2);
+        EXPECT_THROW(image.path_to_inode("/a/x/e.txt"), std::logic_error);
+        EXPECT_THROW(image.path_to_inode("/a/x"), std::logic_error);
+
+        // Deleted Entries Are Never Served From The Cache.
+        EXPECT_NO_THROW(image.fdelete("/a/b/c.txt"));
+        EXPECT_THROW(image.path_to_inode("/a/b/c.txt"), std::logic_error);
+        EXPECT_NO_THROW(image.rmdir("/a"));
+        EXPECT_THROW(image.fopen("/a/b/d.txt"), std::logic_error);
+        EXPECT_THROW(image.path_to_inode("/a"), std::logic_error);
+
+        // A Recycled Name Resolves To The New Inode.
+        EXPECT_NO_THROW(image.mkdir("/a"));
+        EXPECT_NO_THROW(image.fcreate("/a/c.txt"));
+        EXPECT_EQ(image.inode_list[image.path_to_inode("/a/c.txt")].name, std::string("c.txt"));
+        EXPECT_THROW(image.path_to_inode("/a/b"), std::logic_error);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+TEST(JRFSFileAndDir, CheckBufferedAppends)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string record(100, 'r');
+    constexpr int records = 1000;
+
+    {
+        jrfs::filesystem image(2000, test_image);
+        image.fcreate("/append.log");
+        auto writer = image.fopen("/append.log");
+        auto reader = image.fopen("/append.log");
+
+        writer.write(record);
+        EXPECT_EQ(0, image.inode_list[reader.node_id()].size); // Buffered In The Writer.
+        EXPECT_EQ(record, writer.read(record.size())); // But The Writer Reads Its Own Writes.
+        EXPECT_EQ(record, reader.read(record.size()));
+
+        for (int i = 1; i < records; ++i)
+            writer.write(record);
+        EXPECT_LT(records * record.size() - image.inode_list[reader.node_id()].size, jrfs::kWriteBufferBlocks * jrfs::data_block::kContentSize);
+        writer.flush();
+
+        std::string expected;
+        for (int i = 0; i < records; ++i)
+            expected += record;
+        EXPECT_EQ(expected, reader.read(expected.size()));
+
+        // A Write That Cannot Be Flushed Fails As A Whole.
+        EXPECT_THROW(writer.write(std::string(2000 * jrfs::data_block::kContentSize, 'x')), std::logic_error);
+        writer.write(record);
+        writer.flush();
+        EXPECT_EQ(expected.size() + record.size(), image.inode_list[reader.node_id()].size);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckDeletedWhileBuffered)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string record(100, 'r');
+
+    {
+        jrfs::filesystem image(1000, test_image);
+        image.mkdir("/d");
+        image.fcreate("/d/a.txt");
+        image.fcreate("/b.txt");
+        {
+            auto a = image.fopen("/d/a.txt");
+            a.write(record);
+            image.fdelete("/d/a.txt");
+            std::string reused; // Some New File Takes Over The Inode Of a.txt.
+            for (int i = 0; reused.empty() && i < image.meta_data.inode_total; ++i) {
+                image.fcreate("/d/" + std::to_string(i));
+                if (image.path_to_inode("/d/" + std::to_string(i)) == a.node_id())
+                    reused = "/d/" + std::to_string(i);
+            }
+            ASSERT_FALSE(reused.empty());
+
+            EXPECT_THROW(a.flush(), std::logic_error);
+            EXPECT_NO_THROW(a.flush()); // The Buffer Was Dropped.
+            EXPECT_EQ(0, image.inode_list[a.node_id()].size);
+            a.write(record);
+            EXPECT_THROW(a.flush(), std::logic_error);
+            EXPECT_THROW(a.pwrite(record, 0), std::logic_error);
+            EXPECT_EQ(0, image.inode_list[a.node_id()].size);
+
+            auto c = image.fopen(reused);
+            c.write(record);
+            image.rmdir("/d");
+        } // The Destructor Of c Must Not Flush Into The Removed Directory's File.
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        for (size_t i = 0; i < fs.inode_bitmap.size(); ++i)
+            EXPECT_EQ(i == 0 || static_cast<int>(i) == fs.path_to_inode("/b.txt"), fs.inode_bitmap[i]);
+        int used_blocks = 0;
+        for (size_t i = 0; i < fs.block_bitmap.size(); ++i)
+            used_blocks += fs.block_bitmap[i];
+        EXPECT_EQ(used_blocks, 2); // The Reserved Block 0 And The Root's Bucket.
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSFileAndDir, CheckFullImageLeaksNothing)
+{
+    std::string test_image = "./gtest_image.jrfs";
+
+    for (auto mapping : { jrfs::block_mapping::extent, jrfs::block_mapping::indirect }) {
+        jrfs::filesystem image(1000, test_image, jrfs::storage_mode::stream, mapping);
+        image.fcreate("/a.txt");
+        image.fcreate("/b.txt");
+        const int a = image.fopen("/a.txt").node_id();
+        const int b = image.fopen("/b.txt").node_id();
+
+        // Map Until The Inode Itself Is Full: The Next Block Needs A New Extent Tree Root Or Single Indirect Block.
+        int count = 0;
+        while (image.inode_list[a].direct_block[17] == jrfs::kNULL) {
+            image.reserve_blocks(a, ++count);
+            image.reserve_blocks(b, count); // Interleaved, So Extents Stay Short.
+        }
+        const long last = image.block_id(image.inode_list[a], count - 1);
+
+        std::vector<long> filler, spare;
+        for (long id; (id = image.block_bitmap.allocate()) >= 0;)
+            (spare.size() < 2 && id != last + 1 ? spare : filler).push_back(id);
+        image.block_bitmap.reset(spare[0]); // One Block Left: Enough For The Data, Not The Map.
+
+        EXPECT_THROW(image.reserve_blocks(a, count + 1), std::logic_error);
+        EXPECT_FALSE(image.block_bitmap.test(spare[0]));
+        EXPECT_EQ(count, image.block_count(image.inode_list[a]));
+
+        image.block_bitmap.reset(spare[1]);
+        EXPECT_NO_THROW(image.reserve_blocks(a, count + 1));
+        EXPECT_TRUE(image.block_bitmap.test(spare[0]));
+        EXPECT_TRUE(image.block_bitmap.test(spare[1]));
+        EXPECT_EQ(count + 1, image.block_count(image.inode_list[a]));
+
+        for (long id : filler)
+            image.block_bitmap.reset(id);
+    }
+
     if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
         system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
 
@@ -85,7 +85,10 @@ TEST(JRFSImage, CheckImageSize)
         image.seekg(0, std::ios::end);
         const size_t end = image.tellg();
 
-        EXPECT_EQ(end - begin, jrfs::kSuperBlockSize + check_block.block_total * jrfs::kBlockSize + check_block.inode_total * jrfs::kInodeSize);
+        EXPECT_EQ(end - begin, jrfs::kHeaderSize + check_block.block_total * jrfs::kBlockSize + check_block.inode_total * jrfs::kInodeSize + check_block.bitmap_region_size() + check_block.journal_size());
+        EXPECT_GE(check_block.journal_blocks, jrfs::kMinJournalBlocks);
+        EXPECT_EQ(check_block.bitmap_region_size() % jrfs::kBlockSize, 0);
+        EXPECT_GE(check_block.bitmap_region_size(), (check_block.block_total + check_block.inode_total) / 8);
     }
 
     if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
@@ -117,6 +120,407 @@ TEST(JRFSImage, CheckLoad)
         EXPECT_EQ(fs.inode_bitmap.size(), fs.meta_data.inode_total);
     }
 
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckMmapMode)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    constexpr std::string_view test_message = "Hello JRFS Mapped Image!";
+
+    {
+        jrfs::filesystem image(1000, test_image, jrfs::storage_mode::mmap);
+
+        EXPECT_EQ(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+        EXPECT_TRUE(image.inode_list.is_view());
+        EXPECT_TRUE(image.block_list.is_view());
+
+        image.mkdir("/dir");
+        image.fcreate("/dir/mapped.txt");
+        image.fopen("/dir/mapped.txt").write(test_message);
+    }
+
+    { // Stream Mode Can Read What Mmap Mode Wrote.
+        jrfs::filesystem fs(test_image);
+        EXPECT_FALSE(fs.inode_list.is_view());
+
+        auto handler = fs.fopen("/dir/mapped.txt");
+        EXPECT_EQ(test_message, handler.read(test_message.size()));
+
+        fs.fcreate("/streamed.txt");
+        fs.fopen("/streamed.txt").write(test_message);
+    }
+
+    { // And Vice Versa.
+        jrfs::filesystem fs(test_image, jrfs::storage_mode::mmap);
+
+        EXPECT_EQ(fs.meta_data.block_total, 1000);
+        EXPECT_EQ(fs.block_list.size(), fs.meta_data.block_total);
+        EXPECT_EQ(fs.inode_list.size(), fs.meta_data.inode_total);
+
+        auto handler = fs.fopen("/streamed.txt");
+        EXPECT_EQ(test_message, handler.read(test_message.size()));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckIncrementalSync)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string first(900, 'a'), second(10, 'b');
+
+    {
+        jrfs::filesystem image(1000, test_image);
+        EXPECT_TRUE(image.dirty_inodes.empty());
+        EXPECT_TRUE(image.dirty_blocks.empty());
+
+        image.fcreate("/log.txt");
+        image.fopen("/log.txt").write(first);
+        EXPECT_EQ(image.dirty_inodes.size(), 2); // Root & The File.
+        EXPECT_EQ(image.dirty_blocks.size(), 3); // The Root's Bucket & Two Data Blocks.
+
+        image.sync_image();
+        EXPECT_TRUE(image.dirty_inodes.empty());
+        EXPECT_TRUE(image.dirty_blocks.empty());
+    }
+
+    { // A Small Append Only Dirties The File Inode And Its Tail Block.
+        jrfs::filesystem fs(test_image);
+        auto handler = fs.fopen("/log.txt");
+        handler.write(second);
+        EXPECT_TRUE(fs.dirty_blocks.empty()); // Still Buffered In The Handle.
+        handler.flush();
+        EXPECT_EQ(fs.dirty_inodes.size(), 1);
+        EXPECT_EQ(fs.dirty_blocks.size(), 1);
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        auto handler = fs.fopen("/log.txt");
+        EXPECT_EQ(first + second, handler.read(first.size() + second.size()));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckLayoutMismatch)
+{
+    std::string test_image = "./gtest_image.jrfs";
+
+    {
+        jrfs::filesystem image(1000, test_image);
+    }
+
+    { // Pretend The Image Comes From A Machine With Another Byte Order.
+        std::fstream image(test_image, std::ios::in | std::ios::out | std::ios::binary);
+        image.seekp(sizeof(int));
+        const uint32_t swapped = 0x04030201;
+        image.write(reinterpret_cast<const char*>(&swapped), sizeof(swapped));
+    }
+
+    EXPECT_THROW(jrfs::filesystem fs(test_image), std::logic_error);
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+static void expect_same_bitmaps(jrfs::filesystem& fs)
+{
+    std::vector<bool> inodes, blocks;
+    for (size_t i = 0; i < fs.inode_bitmap.size(); ++i)
+        inodes.push_back(fs.inode_bitmap[i]);
+    for (size_t i = 0; i < fs.block_bitmap.size(); ++i)
+        blocks.push_back(fs.block_bitmap[i]);
+
+    fs.scan_bitmap(); // What A Full Scan Would Give.
+
+    for (size_t i = 0; i < fs.inode_bitmap.size(); ++i)
+        EXPECT_EQ(inodes[i], fs.inode_bitmap[i]) << "inode " << i;
+    for (size_t i = 0; i < fs.block_bitmap.size(); ++i)
+        EXPECT_EQ(blocks[i], fs.block_bitmap[i]) << "block " << i;
+}
+
+TEST(JRFSImage, CheckPersistedBitmap)
+{
+    std::string test_image = "./gtest_image.jrfs";
+
+    {
+        jrfs::filesystem image(1000, test_image);
+        image.mkdir("/dir");
+        image.fcreate("/dir/a.txt");
+        image.fopen("/dir/a.txt").write(std::string(3000, 'a'));
+        image.fcreate("/b.txt");
+        image.fopen("/b.txt").write(std::string(100, 'b'));
+        image.fdelete("/b.txt");
+    }
+
+    { // Cleanly Unmounted.
+        std::fstream image(test_image, std::ios::in | std::ios::binary);
+        jrfs::super_block check_block;
+        check_block.read(image);
+        EXPECT_TRUE(check_block.clean);
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        EXPECT_FALSE(fs.meta_data.clean);
+        expect_same_bitmaps(fs);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckCrashRecovery)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string content(3000, 'c');
+
+    {
+        auto image = std::make_unique<jrfs::filesystem>(1000, test_image);
+        image->mkdir("/dir");
+        image->fcreate("/dir/c.txt");
+        image->fopen("/dir/c.txt").write(content);
+        image->sync_image();
+        image.release(); // Crash: Never Unmounted.
+    }
+
+    {
+        jrfs::filesystem fs(test_image); // Falls Back To scan_bitmap().
+        EXPECT_EQ(content, fs.fopen("/dir/c.txt").read(content.size()));
+        expect_same_bitmaps(fs);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckJournalReplay)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string record(900, 'r');
+    constexpr int records = 100; // Far More Than The Journal Holds, So It Checkpoints Along The Way.
+
+    {
+        auto image = std::make_unique<jrfs::filesystem>(1000, test_image);
+        image->mkdir("/logs");
+        image->fcreate("/logs/app.log");
+        image->fcreate("/gone.txt");
+        auto handler = image->fopen("/logs/app.log");
+        for (int i = 0; i < records; ++i)
+            handler.write(record);
+        image->fdelete("/gone.txt");
+        image.release(); // Crash: Neither Synced Nor Unmounted.
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        std::string expected;
+        for (int i = 0; i < records; ++i)
+            expected += record;
+        EXPECT_EQ(expected, fs.fopen("/logs/app.log").read(expected.size()));
+        EXPECT_THROW(fs.path_to_inode("/gone.txt"), std::logic_error);
+        expect_same_bitmaps(fs);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckOversizedTransaction)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string content(300 * jrfs::data_block::kContentSize, 'o'); // Six Times The Journal.
+    const std::string overwrite(content.size(), 'w');
+
+    {
+        auto image = std::make_unique<jrfs::filesystem>(1000, test_image);
+        image->fcreate("/big.bin");
+        image->fopen("/big.bin").write(content); // New Blocks: Written Home First, Then Only The Map Is Logged.
+        EXPECT_EQ(0u, image->stats().unjournaled_commits);
+        image.release(); // Crash: Neither Synced Nor Unmounted.
+    }
+
+    {
+        auto image = std::make_unique<jrfs::filesystem>(test_image);
+        EXPECT_EQ(content, image->fopen("/big.bin").read(content.size()));
+        expect_same_bitmaps(*image);
+
+        image->fopen("/big.bin").pwrite(overwrite, 0); // Overwrites Have No Other Home: Counted.
+        EXPECT_EQ(jrfs::kMetricsEnabled ? 1u : 0u, image->stats().unjournaled_commits);
+        image.release();
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        EXPECT_EQ(overwrite, fs.fopen("/big.bin").read(overwrite.size()));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckBatchCommit)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string record(100, 'r');
+    constexpr int records = 200;
+
+    {
+        auto image = std::make_unique<jrfs::filesystem>(1000, test_image);
+        {
+            jrfs::filesystem::batch batch(*image);
+            image->fcreate("/ingest.log");
+            auto handler = image->fopen("/ingest.log");
+            for (int i = 0; i < records; ++i)
+                handler.write(record);
+            EXPECT_FALSE(image->pending_blocks.empty()); // Nothing Committed Yet.
+
+            {
+                jrfs::filesystem::batch nested(*image);
+                image->mkdir("/nested");
+            }
+            EXPECT_FALSE(image->pending_inodes.empty()); // Only The Outermost Batch Commits.
+        }
+        EXPECT_TRUE(image->pending_inodes.empty());
+        EXPECT_TRUE(image->pending_blocks.empty());
+
+        {
+            jrfs::filesystem::batch batch(*image);
+            image->fcreate("/mine.txt");
+            EXPECT_FALSE(image->pending_inodes.empty());
+            std::thread([&image] { image->fcreate("/theirs.txt"); }).join();
+            EXPECT_TRUE(image->pending_inodes.empty()); // Other Threads Still Commit, Taking The Batch So Far Along.
+            image->fcreate("/mine_too.txt");
+            EXPECT_FALSE(image->pending_inodes.empty());
+        }
+
+        jrfs::filesystem::batch batch(*image);
+        image->fcreate("/async.txt");
+        image->fopen("/async.txt").write(record);
+        auto first = image->commit_async();
+        auto second = image->commit_async();
+        EXPECT_NO_THROW(first.get());
+        EXPECT_NO_THROW(second.get());
+        EXPECT_TRUE(image->pending_blocks.empty());
+
+        batch.commit();
+        EXPECT_THROW(batch.commit(), std::logic_error);
+        image.release(); // Crash: Neither Synced Nor Unmounted.
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        std::string expected;
+        for (int i = 0; i < records; ++i)
+            expected += record;
+        EXPECT_EQ(expected, fs.fopen("/ingest.log").read(expected.size()));
+        EXPECT_EQ(record, fs.fopen("/async.txt").read(record.size()));
+        EXPECT_NO_THROW(fs.path_to_inode("/nested"));
+        for (auto path : { "/mine.txt", "/theirs.txt", "/mine_too.txt" })
+            EXPECT_NO_THROW(fs.path_to_inode(path));
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckBoundedBlockCache)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    constexpr size_t capacity = 64;
+    std::string content;
+    for (int i = 0; i < 500 * static_cast<int>(sizeof(jrfs::data_block)); ++i)
+        content += static_cast<char>('a' + i % 26);
+
+    {
+        jrfs::filesystem fs(2000, test_image, jrfs::storage_mode::stream, jrfs::block_mapping::extent, capacity);
+        fs.fcreate("/big.bin");
+        auto handler = fs.fopen("/big.bin");
+        for (size_t done = 0; done < content.size(); done += 4096)
+            handler.write(content.substr(done, 4096));
+        EXPECT_LE(fs.block_list.resident_count(), capacity);
+        EXPECT_GT(fs.block_list.evictions(), 0u);
+
+        // Freshly Allocated Blocks Are Zeroed In Memory, Never Read From Disk Only To Be Overwritten.
+        fs.fcreate("/fresh.bin");
+        auto fresh = fs.fopen("/fresh.bin");
+        const size_t misses = fs.block_list.misses();
+        fresh.write(std::string(100 * jrfs::data_block::kContentSize, 'f'));
+        EXPECT_EQ(misses, fs.block_list.misses());
+        EXPECT_LE(fs.block_list.resident_count(), capacity);
+    }
+
+    {
+        jrfs::filesystem fs(test_image, jrfs::storage_mode::stream, capacity);
+        EXPECT_EQ(0u, fs.block_list.resident_count()); // Nothing But Inodes Is Read At Mount.
+        EXPECT_EQ(content, fs.fopen("/big.bin").read(content.size()));
+        EXPECT_GT(fs.block_list.misses(), 0u);
+        EXPECT_LE(fs.block_list.resident_count(), capacity);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
+
+TEST(JRFSImage, CheckSequentialReadahead)
+{
+    std::string test_image = "./gtest_image.jrfs";
+    constexpr size_t capacity = 256;
+    constexpr int step = 4096;
+    std::string content;
+    for (int i = 0; i < 1500 * jrfs::data_block::kContentSize; ++i)
+        content += static_cast<char>('a' + i % 26);
+
+    {
+        jrfs::filesystem fs(4000, test_image);
+        fs.fcreate("/scan.log");
+        fs.fopen("/scan.log").write(content);
+    }
+
+    {
+        jrfs::filesystem fs(test_image, jrfs::storage_mode::stream, capacity);
+        auto handler = fs.fopen("/scan.log");
+        std::string scanned;
+        for (int done = 0; done < static_cast<int>(content.size()); done += step) {
+            handler.seekp(done);
+            scanned += handler.read(std::min<int>(step, content.size() - done));
+        }
+        EXPECT_EQ(content, scanned);
+        EXPECT_GE(fs.block_list.prefetches(), 1500u);
+        EXPECT_LT(fs.block_list.misses(), 15u); // Blocks Are Read In Batches Ahead Of Use.
+        EXPECT_LE(fs.block_list.resident_count(), capacity);
+
+        handler.seekp(0); // Random Access Reads Only What It Asks For.
+        const size_t before = fs.block_list.prefetches() + fs.block_list.misses();
+        EXPECT_EQ(content.substr(0, 10), handler.read(10));
+        EXPECT_LE(fs.block_list.prefetches() + fs.block_list.misses(), before + 1);
+    }
+
     if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
         system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
 
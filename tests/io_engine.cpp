@@ -0,0 +1,87 @@
+#include <JRFS/details/image_file.hpp>
+#include <JRFS/details/io_engine.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static void check_round_trip(jrfs::io_backend backend)
+{
+    const std::string test_file = "./gtest_io_engine.bin";
+    constexpr size_t size = 3 * jrfs::io_engine::kMaxPieceSize + 123;
+    {
+        jrfs::image_file file(test_file, true);
+        file.resize(size);
+        jrfs::io_engine io(file.fd(), backend);
+        ASSERT_EQ(backend, io.backend());
+
+        std::vector<char> data(size);
+        std::iota(data.begin(), data.end(), 0);
+
+        // One Huge Request Split Into Pieces, Plus Many Small Ones Overwriting Its Head.
+        std::vector<jrfs::io_request> writes { { true, 0, data.data(), size } };
+        io.run(writes);
+        std::vector<char> small(100 * 512, 'x');
+        writes.clear();
+        for (size_t i = 0; i < 100; ++i)
+            writes.push_back({ true, i * 512, small.data() + i * 512, 512 });
+        io.run(writes);
+        std::fill_n(data.begin(), small.size(), 'x');
+
+        std::vector<char> back(size);
+        auto ready = io.submit({ { false, 0, back.data(), size / 2 }, { false, size / 2, back.data() + size / 2, size - size / 2 } });
+        EXPECT_NO_THROW(ready.get());
+        EXPECT_EQ(data, back);
+
+        // Reading Past The End Of The File Is Reported Through The Future.
+        char tail[16];
+        auto failed = io.submit({ { false, size - 8, tail, sizeof(tail) } });
+        EXPECT_THROW(failed.get(), std::logic_error);
+
+        EXPECT_NO_THROW(io.run({}));
+
+        // Concurrent Submitters Together Queue Far More Pieces Than The Rings Hold.
+        constexpr size_t threads = 4, per_thread = 300;
+        std::vector<char> stripes(threads * per_thread * 64);
+        for (size_t i = 0; i < stripes.size(); ++i)
+            stripes[i] = static_cast<char>(i / 64);
+        std::vector<std::thread> submitters;
+        for (size_t t = 0; t < threads; ++t)
+            submitters.emplace_back([&io, &stripes, t] {
+                std::vector<jrfs::io_request> stripe;
+                for (size_t i = t; i < threads * per_thread; i += threads)
+                    stripe.push_back({ true, i * 64, stripes.data() + i * 64, 64 });
+                EXPECT_NO_THROW(io.run(stripe));
+            });
+        for (auto& submitter : submitters)
+            submitter.join();
+        std::vector<char> stripes_back(stripes.size());
+        io.run({ { false, 0, stripes_back.data(), stripes_back.size() } });
+        EXPECT_EQ(stripes, stripes_back);
+    }
+    std::remove(test_file.c_str());
+}
+
+TEST(IOEngine, CheckUring)
+{
+    bool available;
+    {
+        jrfs::image_file file("./gtest_io_engine.bin", true);
+        available = jrfs::io_engine(file.fd(), jrfs::io_backend::uring).backend() == jrfs::io_backend::uring;
+    }
+    if (!available) {
+        std::remove("./gtest_io_engine.bin");
+        GTEST_SKIP() << "io_uring Not Available, The Thread Pool Was Selected Instead.";
+    }
+    check_round_trip(jrfs::io_backend::uring);
+}
+
+TEST(IOEngine, CheckThreadPool)
+{
+    jrfs::image_file file("./gtest_io_engine.bin", true);
+    EXPECT_EQ(jrfs::io_engine(file.fd(), jrfs::io_backend::thread_pool).backend(), jrfs::io_backend::thread_pool);
+    check_round_trip(jrfs::io_backend::thread_pool);
+}
\ No newline at end of file
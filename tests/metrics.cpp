@@ -0,0 +1,81 @@
+#include "test_util.hpp"
+
+TEST(JRFSMetrics, CheckHistogramBuckets)
+{
+    using jrfs::latency_histogram;
+
+    // Small Values Are Exact, Larger Ones Within 1 / kSubBuckets.
+    for (uint64_t v : { 0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull }) {
+        const int bucket = latency_histogram::bucket_of(v);
+        ASSERT_LT(bucket, latency_histogram::kBuckets);
+        const uint64_t upper = latency_histogram::upper_bound(bucket);
+        EXPECT_GE(upper, v);
+        EXPECT_LE(upper - v, v / latency_histogram::kSubBuckets);
+        if (bucket > 0) {
+            EXPECT_LT(latency_histogram::upper_bound(bucket - 1), v);
+        }
+    }
+
+    latency_histogram h;
+    for (uint64_t v = 1; v <= 1000; ++v)
+        h.record(v);
+    const auto s = h.get();
+    EXPECT_EQ(1000u, s.count);
+    EXPECT_EQ(1000u, s.max);
+    EXPECT_DOUBLE_EQ(500.5, s.mean());
+    EXPECT_NEAR(500, s.percentile(50), 500 / latency_histogram::kSubBuckets);
+    EXPECT_NEAR(990, s.percentile(99), 990 / latency_histogram::kSubBuckets);
+    EXPECT_EQ(1000u, s.percentile(100));
+
+    h.reset();
+    EXPECT_EQ(0u, h.get().count);
+    EXPECT_EQ(0u, h.get().percentile(50));
+}
+
+TEST(JRFSMetrics, CheckFilesystemStats)
+{
+    if (!jrfs::kMetricsEnabled)
+        GTEST_SKIP() << "Built Without JRFS_METRICS.";
+
+    std::string test_image = "./gtest_image.jrfs";
+    const std::string content(5000, 'm');
+
+    {
+        jrfs::filesystem fs(1000, test_image);
+        fs.reset_stats(); // Creating The Image Syncs It Once.
+        fs.fcreate("/a.txt");
+        {
+            auto handler = fs.fopen("/a.txt");
+            handler.write(content);
+            EXPECT_EQ(content, handler.read(content.size()));
+        }
+        fs.path_to_inode("/a.txt");
+        fs.sync_image();
+
+        const auto stats = fs.stats();
+        EXPECT_EQ(1u, stats[jrfs::metric_op::fopen].count);
+        EXPECT_EQ(3u, stats[jrfs::metric_op::path_to_inode].count); // The Parent In fcreate, fopen & path_to_inode.
+        EXPECT_EQ(1u, stats[jrfs::metric_op::read].count);
+        EXPECT_EQ(1u, stats[jrfs::metric_op::write].count);
+        EXPECT_GE(stats[jrfs::metric_op::allocate].count, 1u);
+        EXPECT_EQ(1u, stats[jrfs::metric_op::sync_image].count);
+        EXPECT_EQ(content.size(), stats.bytes_read);
+        EXPECT_EQ(content.size(), stats.bytes_written);
+        EXPECT_GE(stats.blocks_allocated, (content.size() + jrfs::data_block::kContentSize - 1) / jrfs::data_block::kContentSize);
+        EXPECT_GE(stats.scan_length.count, 1u);
+        EXPECT_NE(std::string::npos, stats.report().find("sync_image"));
+
+        fs.reset_stats();
+        EXPECT_EQ(0u, fs.stats()[jrfs::metric_op::fopen].count);
+    }
+
+    {
+        jrfs::filesystem fs(test_image);
+        EXPECT_EQ(1u, fs.stats()[jrfs::metric_op::load_image].count);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "test_util.hpp"
+
+#include <JRFS/util/utility.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocations { 0 };
+
+// Replacements Are Kept Out Of Line: Once Inlined, GCC Pairs The malloc() In One With The free() In
+// Another And Reports Them As Mismatched (-Wmismatched-new-delete).
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST(JRFSPathLookup, CheckSplitViewDoesNotAllocate)
+{
+    const std::string_view path = "/a/rather/deep/path/to/some/file.txt";
+
+    const size_t before = allocations;
+    size_t count = 0;
+    for (auto token : jrfs::utility::split_view(path, '/'))
+        count += token.size();
+    EXPECT_EQ(allocations, before);
+    EXPECT_EQ(count, path.size() - 7);
+}
+
+TEST(JRFSPathLookup, CheckLookupDoesNotAllocate)
+{
+    std::string test_image = "./gtest_image.jrfs";
+
+    {
+        jrfs::filesystem image(100, test_image);
+        EXPECT_NO_THROW(image.mkdir("/usr"));
+        EXPECT_NO_THROW(image.mkdir("/usr/lib/"));
+        EXPECT_NO_THROW(image.fcreate("/usr/lib/libjrfs.so"));
+        EXPECT_THROW(image.mkdir("/usr/"), std::logic_error);
+        EXPECT_THROW(image.fcreate("/"), std::logic_error);
+        EXPECT_THROW(image.fcreate("relative.txt"), std::logic_error);
+
+        const int expected = image.path_to_inode("/usr/lib/libjrfs.so");
+
+        // Both A Cached Full Path And A Walk Through Cached Levels.
+        const size_t before = allocations;
+        EXPECT_EQ(image.path_to_inode(std::string_view("/usr/lib/libjrfs.so")), expected);
+        EXPECT_EQ(image.resolve_path(jrfs::utility::split_view("/usr/lib/libjrfs.so", '/'), "/usr/lib/libjrfs.so"), expected);
+        auto handler = image.fopen(std::string_view("/usr/lib/libjrfs.so"));
+        EXPECT_EQ(allocations, before);
+        EXPECT_EQ(handler.node_id(), expected);
+
+        // A Miss Allocates To Cache What It Found, After Which The Same Lookup Is Allocation-Free Again.
+        image.dentries.clear();
+        EXPECT_EQ(image.path_to_inode(std::string_view("/usr/lib/libjrfs.so")), expected);
+        EXPECT_GT(allocations, before);
+        const size_t warm = allocations;
+        EXPECT_EQ(image.path_to_inode(std::string_view("/usr/lib/libjrfs.so")), expected);
+        EXPECT_EQ(allocations, warm);
+    }
+
+    if (system(("ls " + test_image + ">/dev/null 2>&1").c_str()) == 0)
+        system(("rm " + test_image + ">/dev/null 2>&1").c_str()); // Clean the file.
+
+    EXPECT_NE(0, system(("ls " + test_image + ">/dev/null 2>&1").c_str()));
+}
\ No newline at end of file